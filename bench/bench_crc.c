@@ -0,0 +1,95 @@
+/* CRC16实现测速：依次用tt_crc_select切换各实现，按固定帧长测算每字节周期数
+ * 编译（仓库根目录）：cc -O2 -I. -o bench_crc bench/bench_crc.c tt_crc.c
+ * 用法：./bench_crc [总字节数MB，默认64]
+ * x86上用rdtsc计数（TSC频率，非睿频下的实际周期），其他平台按纳秒输出。
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "tt_crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC       1
+#else
+#define BENCH_TSC       0
+#endif
+
+static const u32_t sizes[] = { 16, 64, 185, 512, 1400, 4096, 65536 };
+
+static u8_t buf[65536 + 8];
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned long long now_cyc(void)
+{
+#if BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    double total = (argc > 1 ? atof(argv[1]) : 64) * 1024 * 1024;
+    s32_t def = tt_crc_impl();
+    s32_t impl;
+    u32_t i, k;
+
+    for (i = 0; i < sizeof(buf); ++i) buf[i] = (u8_t) rand();
+
+    printf("default %s, %s per byte\n", tt_crc_name(def), BENCH_TSC ? "tsc cycles" : "ns");
+    printf("%-10s", "impl");
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) printf("%9u", sizes[k]);
+    printf("\n");
+
+    for (impl = TT_CRC_BIT; impl < TT_CRC_AUTO; ++impl) {
+        if (tt_crc_select(impl) != impl) {
+            printf("%-10s unsupported\n", tt_crc_name(impl));
+            continue;
+        }
+
+        /* 先确认结果正确，避免测到错误的实现 */
+        if (tt_crc16(TT_CRC_INIT, (const u8_t*) "123456789", 9) != 0x31C3) {
+            printf("%-10s check value mismatch\n", tt_crc_name(impl));
+            return 1;
+        }
+
+        printf("%-10s", tt_crc_name(impl));
+        for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+            u32_t len = sizes[k];
+            /* 逐位实现很慢，只测1/16的数据量 */
+            u32_t n = (u32_t) (total / len / (impl == TT_CRC_BIT ? 16 : 1)) + 1;
+            volatile u16_t sink = 0;
+            unsigned long long c0, c1;
+            double t0, t1;
+            u32_t j;
+
+            t0 = now_ns();
+            c0 = now_cyc();
+            /* 起始地址错开，包含非对齐的情况 */
+            for (j = 0; j < n; ++j) sink ^= tt_crc16((u16_t) j, buf + (j & 7), len);
+            c1 = now_cyc();
+            t1 = now_ns();
+
+            printf("%9.3f", BENCH_TSC ? (double) (c1 - c0) / n / len : (t1 - t0) / n / len);
+            (void) sink;
+        }
+        printf("\n");
+    }
+
+    tt_crc_select(def);
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/* 负载压缩测速：按单包独立压缩（与tt_set_lz相同），统计压缩率与编解码吞吐，并与不压缩（memcpy）对比
+ * 编译（仓库根目录）：cc -O2 -I. -o bench_lz bench/bench_lz.c tt_lz.c
+ * 用法：./bench_lz [负载长度，默认176即185字节mtu的负载] [链路波特率，默认115200]
+ * 压缩后不小于原长的包按不压缩发送，计入原长（不解压，不计入解压吞吐）。
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "tt_lz.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NFRM            4096
+#define MAXPL           1400
+
+static u8_t frm[NFRM][MAXPL];
+static u8_t cmp[NFRM][MAXPL];
+static u32_t clen[NFRM];
+static u8_t out[MAXPL];
+static u16_t tab[TT_LZ_HSZ];
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 文本遥测（字段名重复，数值变化） */
+static void gen_text(u8_t* p, u32_t len)
+{
+    char line[64];
+    u32_t o = 0;
+    s32_t n, i;
+
+    while (o < len) {
+        n = snprintf(line, sizeof(line), "T=%d.%d,P=%d,H=%d;",
+                     20 + rand() % 3, rand() % 10, 1013 + rand() % 2, 40 + rand() % 5);
+        for (i = 0; i < n && o < len; ++i) p[o++] = (u8_t) line[i];
+    }
+}
+
+/* 二进制采样（16位小端，缓慢变化），压缩收益有限 */
+static void gen_bin(u8_t* p, u32_t len)
+{
+    u16_t v = (u16_t) rand();
+    u32_t o;
+
+    for (o = 0; o + 1 < len; o += 2) {
+        v = (u16_t) (v + rand() % 5 - 2);
+        p[o] = (u8_t) v;
+        p[o + 1] = (u8_t) (v >> 8);
+    }
+}
+
+/* 随机数据（不可压缩，测放弃压缩的开销） */
+static void gen_rand(u8_t* p, u32_t len)
+{
+    u32_t o;
+
+    for (o = 0; o < len; ++o) p[o] = (u8_t) rand();
+}
+
+static s32_t run(const char* name, void (*gen)(u8_t*, u32_t), u32_t len, u32_t baud)
+{
+    u32_t rounds = (u32_t) (64u * 1024 * 1024 / ((unsigned long long) len * NFRM)) + 1;
+    unsigned long long raw = 0, wire = 0, dec = 0;
+    volatile u32_t sink = 0;
+    double t0, tc, td, tm;
+    u32_t r, f;
+
+    srand(2);
+    for (f = 0; f < NFRM; ++f) gen(frm[f], len);
+
+    t0 = now_s();
+    for (r = 0; r < rounds; ++r) {
+        for (f = 0; f < NFRM; ++f) clen[f] = tt_lz_compress(tab, frm[f], len, cmp[f], len - 1);
+    }
+    tc = now_s() - t0;
+
+    for (f = 0; f < NFRM; ++f) {
+        raw += len;
+        wire += clen[f] ? clen[f] : len;
+        if (clen[f]) dec += len;
+    }
+
+    t0 = now_s();
+    for (r = 0; r < rounds; ++r) {
+        for (f = 0; f < NFRM; ++f) {
+            if (!clen[f]) continue;
+            if (tt_lz_decompress(cmp[f], clen[f], out, len) != (s32_t) len) {
+                printf("%s: frame %u decompress failed\n", name, f);
+                return -1;
+            }
+            sink += out[0];
+        }
+    }
+    td = now_s() - t0;
+
+    for (f = 0; f < NFRM; ++f) {
+        if (clen[f] && (tt_lz_decompress(cmp[f], clen[f], out, len) != (s32_t) len || memcmp(out, frm[f], len))) {
+            printf("%s: frame %u mismatch\n", name, f);
+            return -1;
+        }
+    }
+
+    /* 不压缩时负载只需拷贝一次 */
+    t0 = now_s();
+    for (r = 0; r < rounds; ++r) {
+        for (f = 0; f < NFRM; ++f) {
+            memcpy(out, frm[f], len);
+            sink += out[len - 1];
+        }
+    }
+    tm = now_s() - t0;
+    (void) sink;
+
+    {
+        double mb = (double) raw * rounds / 1e6;
+        /* 解压吞吐只按压缩过的包计算 */
+        double mbd = (double) dec * rounds / 1e6;
+        /* 每字节按10位（8N1）计算链路传输时间 */
+        double link = (double) len * 10 / baud * 1e6;
+        double linkz = (double) wire / NFRM * 10 / baud * 1e6;
+
+        printf("%-6s ratio %.3f  comp %7.1f MB/s  decomp %7.1f MB/s  memcpy %8.1f MB/s  "
+               "codec %.2f us/frame  link %.0f -> %.0f us/frame\n",
+               name, (double) wire / raw, mb / tc, dec ? mbd / td : 0, mb / tm,
+               (tc + td) / ((double) rounds * NFRM) * 1e6, link, linkz);
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    u32_t len = argc > 1 ? (u32_t) atoi(argv[1]) : 176;
+    u32_t baud = argc > 2 ? (u32_t) atoi(argv[2]) : 115200;
+
+    if (len < 2 || len > MAXPL || !baud) {
+        printf("usage: %s [len 2..%d] [baud]\n", argv[0], MAXPL);
+        return 1;
+    }
+
+    printf("payload %u bytes, %u frames, %u baud\n", len, NFRM, baud);
+
+    if (run("text", gen_text, len, baud) < 0) return 1;
+    if (run("binary", gen_bin, len, baud) < 0) return 1;
+    if (run("random", gen_rand, len, baud) < 0) return 1;
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+# 编译并运行tests/下的测试（test_*.c，以及用C++20编译的test_*.cpp，各自独立，与共用的tt_test.c一起编译，
+# 返回0表示通过，失败原因输出到stderr）
+# 协议日志（tt_println）输出到stdout，保存在临时目录中，测试失败时显示最后几行。
+# 核心源码tt_new.c/tt_new.h按发布时的文件名tt.c/tt.h复制到临时目录后与各模块一起编译。
+# 用法：tests/run.sh [测试名...]（如 tests/run.sh test_crc），CC、CFLAGS、CXX、CXXFLAGS可通过环境变量指定
+set -e
+
+top=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:--O2 -g -Wall}
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:-$CFLAGS}
+
+for f in "$top"/*.c "$top"/*.h "$top"/*.hpp; do
+    case "$(basename "$f")" in
+        tt.c|tt.h) continue ;;
+    esac
+    cp "$f" "$tmp/"
+done
+mv "$tmp/tt_new.c" "$tmp/tt.c"
+mv "$tmp/tt_new.h" "$tmp/tt.h"
+
+for f in "$tmp"/*.c; do
+    $CC $CFLAGS -c "$f" -o "${f%.c}.o"
+done
+$CC $CFLAGS -I"$tmp" -c "$top/tests/tt_test.c" -o "$tmp/tt_test.o"
+
+if [ $# -eq 0 ]; then
+    set -- $(cd "$top/tests" && ls test_*.c test_*.cpp)
+fi
+
+fail=0
+for t in "$@"; do
+    t=${t%.c}
+    t=${t%.cpp}
+    if [ -f "$top/tests/$t.cpp" ]; then
+        cc="$CXX -std=c++20 $CXXFLAGS"
+        src="$top/tests/$t.cpp"
+    else
+        cc="$CC $CFLAGS"
+        src="$top/tests/$t.c"
+    fi
+    if $cc -I"$tmp" "$src" "$tmp"/*.o -o "$tmp/$t" -lpthread && "$tmp/$t" > "$tmp/$t.log"; then
+        echo "PASS $t"
+    else
+        [ -f "$tmp/$t.log" ] && tail -n 20 "$tmp/$t.log"
+        echo "FAIL $t"
+        fail=1
+    fi
+done
+
+exit $fail
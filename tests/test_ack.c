@@ -0,0 +1,155 @@
+/* 延迟ACK：按个数（ackn）、按时间（ackd）及两者同时设置时，接收方回复的ACK包明显少于默认策略，丢包下数据完整；
+ * 按个数时第n个包到达才回复，按时间时最早的包等待ackd毫秒后回复，乱序的包立即回复
+ */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (256 * 1024)
+#define MTU     1000
+
+static u8_t src[LEN], dst[LEN];
+
+/* 取出from所有待发送的包，按loss%丢弃后输入to，返回取出的包数 */
+static u32_t drain(tt_t* from, tt_t* to, u32_t loss)
+{
+    u8_t f[MTU];
+    u32_t n = 0;
+    s32_t r;
+
+    while ((r = tt_poll_output(from, f, sizeof(f))) > 0) {
+        ++n;
+        if ((u32_t) rand() % 100 >= loss) tt_input(to, f, (u32_t) r);
+    }
+
+    return n;
+}
+
+/* 逐个取出a待发送的包输入b，每输入一个包就取出b的回复输入a（如同接收方每读到一个数据报就处理一次），
+ * 返回b发出的包数
+ */
+static u32_t pump(tt_t* a, tt_t* b, u32_t loss)
+{
+    u8_t f[MTU];
+    u32_t n = 0;
+    s32_t r;
+
+    while ((r = tt_poll_output(a, f, sizeof(f))) > 0) {
+        if ((u32_t) rand() % 100 >= loss) tt_input(b, f, (u32_t) r);
+        n += drain(b, a, loss);
+    }
+
+    return n;
+}
+
+/* a向b传输LEN字节，返回b发出的包数（都是ACK），失败返回0 */
+static u32_t run(u16_t n, u16_t delay, u32_t loss)
+{
+    tt_t a, b;
+    u32_t now = 0, got = 0, nack = 0;
+
+    srand(5);
+
+    if (tt_init(&a, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) != 0) return 0;
+    if (tt_init(&b, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) != 0) return 0;
+    tt_set_ack(&b, n, delay);
+    if (tt_submit(&a, src, LEN) != 0) return 0;
+
+    while (tt_acked(&a) < LEN || got < LEN) {
+        if (now >= 600000) {
+            fprintf(stderr, "ack %u/%u loss %u: %u/%u after %u ms\n", n, delay, loss, got, tt_acked(&a), now);
+            return 0;
+        }
+
+        ++now;
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+
+        nack += pump(&a, &b, loss);
+        got += (u32_t) tt_read(&b, dst + got, (s32_t) (LEN - got));
+        nack += drain(&b, &a, loss);
+    }
+
+    if (memcmp(src, dst, LEN)) {
+        fprintf(stderr, "ack %u/%u loss %u: data mismatch\n", n, delay, loss);
+        return 0;
+    }
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return nack;
+}
+
+/* 逐包输入，检查何时回复ACK */
+static s32_t test_timing(void)
+{
+    u8_t f[4][MTU], o[MTU];
+    s32_t len[4];
+    tt_t a, b;
+    u32_t i;
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+    tt_tick(&a, 1);
+    tt_tick(&b, 1);
+    CHECK(tt_submit(&a, src, 4 * (MTU - TT_SZHDR)) == 0);
+    for (i = 0; i < 4; ++i) CHECK((len[i] = tt_poll_output(&a, f[i], MTU)) == MTU);
+
+    /* 按个数：第3个包到达时才回复 */
+    tt_set_ack(&b, 3, 0);
+    CHECK(tt_input(&b, f[0], (u32_t) len[0]) >= 0);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+    CHECK(tt_input(&b, f[1], (u32_t) len[1]) >= 0);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+    CHECK(tt_input(&b, f[2], (u32_t) len[2]) >= 0);
+    CHECK(tt_poll_output(&b, o, MTU) > 0);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+    tt_reset(&b);
+
+    /* 按时间：最早的包等待20毫秒后回复，之前tt_timeout给出剩余时间 */
+    tt_set_ack(&b, 0, 20);
+    tt_tick(&b, 1);
+    CHECK(tt_input(&b, f[0], (u32_t) len[0]) >= 0);
+    tt_tick(&b, 5);
+    CHECK(tt_input(&b, f[1], (u32_t) len[1]) >= 0);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+    CHECK(tt_timeout(&b) == 16);
+    tt_tick(&b, 20);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+    tt_tick(&b, 21);
+    CHECK(tt_poll_output(&b, o, MTU) > 0);
+    CHECK(tt_poll_output(&b, o, MTU) == 0);
+
+    /* 乱序（跳过f[2]）立即回复 */
+    CHECK(tt_input(&b, f[3], (u32_t) len[3]) >= 0);
+    CHECK(tt_poll_output(&b, o, MTU) > 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i, nd, nn, nt, nb;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    CHECK((nd = run(0, 0, 0)) > 0);
+    CHECK((nn = run(8, 0, 0)) > 0);
+    CHECK((nt = run(0, 10, 0)) > 0);
+    CHECK((nb = run(8, 10, 0)) > 0);
+    CHECK(nn * 2 < nd && nt * 2 < nd && nb * 2 < nd);
+
+    CHECK(run(8, 10, 10) > 0);
+    CHECK(run(0, 10, 10) > 0);
+
+    CHECK(test_timing() == 0);
+
+    return 0;
+}
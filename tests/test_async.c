@@ -0,0 +1,146 @@
+/* 异步发送：大小不一的请求连续放入队列，引擎跨请求连续填充窗口（同时有多个请求未确认），丢包下数据完整、按序完成；
+ * 链路中断时未发完的请求报告已确认的字节数，之后的请求（包括之后放入的）都以TT_ERRSEND完成，对端收到的数据不错乱
+ */
+
+#include "tt_test.h"
+#include "tt_async.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (256 * 1024)
+#define NREQ    400
+
+static u8_t src[LEN], dst[LEN];
+static tt_test_peer p;
+static tt_t a, b;
+
+/* 以下只在引擎线程中（完成回调里）写入 */
+static s32_t res[NREQ];
+static u32_t ndone, maxseg, order;
+
+static void on_done(void* ctx, const u8_t* buf, s32_t rt)
+{
+    u32_t i = (u32_t) (size_t) ctx;
+
+    (void) buf;
+    if (i != ndone) order = 1;
+    res[i] = rt;
+    ++ndone;
+    if (a.nseg > maxseg) maxseg = a.nseg;
+}
+
+/* 把src按off[]切成n个请求放入队列，队列满时等待完成通知 */
+static s32_t run(tt_async* as, const u32_t* off, u32_t n)
+{
+    struct pollfd pfd;
+    u32_t i;
+    s32_t rt;
+
+    pfd.fd = as->efd;
+    pfd.events = POLLIN;
+
+    for (i = 0; i < n; ++i) {
+        while ((rt = tt_async_send(as, src + off[i], off[i + 1] - off[i], (void*) (size_t) i)) == TT_ERRBUSY) {
+            CHECK(poll(&pfd, 1, 1000) >= 0);
+        }
+        /* 数据流中断后放入的请求被拒绝，按失败记录 */
+        if (rt == TT_ERRSEND) break;
+        CHECK(rt == 0);
+    }
+
+    tt_async_stop(as);
+
+    return (s32_t) i;
+}
+
+static s32_t setup(u32_t loss, u32_t cut)
+{
+    memset(&p, 0, sizeof(p));
+    p.peer = &b;
+    p.step = 10;
+    p.loss = loss;
+    p.cut = cut;
+    p.out = dst;
+    p.cap = LEN;
+
+    ndone = maxseg = order = 0;
+
+    CHECK(tt_init(&a, tt_test_rcb, tt_test_wcb, 16, TT_SZPKT, 3, &p) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    tt_set_clock(&a, tt_test_clk);
+
+    return 0;
+}
+
+static s32_t test_stream(u32_t seed, const u32_t* off)
+{
+    tt_async as;
+    u32_t i;
+
+    srand(seed);
+    CHECK(setup(5, 0) == 0);
+    CHECK(tt_async_start(&as, &a, 16, 8, on_done) == 0);
+
+    CHECK(run(&as, off, NREQ) == NREQ);
+
+    CHECK(ndone == NREQ && !order);
+    for (i = 0; i < NREQ; ++i) CHECK(res[i] == (s32_t) (off[i + 1] - off[i]));
+    CHECK(p.nout == off[NREQ] && memcmp(src, dst, off[NREQ]) == 0);
+    /* 小请求不必等上一个确认完，完成时还有之后的请求在途 */
+    CHECK(maxseg > 1);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+static s32_t test_cut(u32_t seed, const u32_t* off)
+{
+    tt_async as;
+    u32_t cut = off[NREQ] / 3;
+    u32_t i, n, k;
+
+    srand(seed);
+    CHECK(setup(0, cut) == 0);
+    CHECK(tt_async_start(&as, &a, 16, 3, on_done) == 0);
+
+    n = (u32_t) run(&as, off, NREQ);
+    CHECK(ndone == n && !order);
+
+    /* 完成的请求依次为：全部确认的、一个未发完的、其余都失败 */
+    for (k = 0; k < n && res[k] == (s32_t) (off[k + 1] - off[k]); ++k);
+    CHECK(k < n);
+    CHECK(res[k] >= 0 && res[k] < (s32_t) (off[k + 1] - off[k]));
+    for (i = k + 1; i < n; ++i) CHECK(res[i] == TT_ERRSEND);
+
+    /* 对端收到的是数据流的前缀，不少于已确认的部分 */
+    CHECK(p.nout >= off[k] + (u32_t) res[k] && p.nout < off[NREQ]);
+    CHECK(memcmp(src, dst, p.nout) == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    static u32_t off[NREQ + 1];
+    u32_t i, seed;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    /* 请求长度从1字节到几个包不等 */
+    for (i = 0; i < NREQ; ++i) off[i + 1] = off[i] + 1 + (u32_t) rand() % (i & 1 ? 100 : 1200);
+
+    for (seed = 1; seed <= 5; ++seed) {
+        CHECK(test_stream(seed, off) == 0);
+        CHECK(test_cut(seed, off) == 0);
+    }
+
+    return 0;
+}
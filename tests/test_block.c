@@ -0,0 +1,181 @@
+/* 阻塞接口：两个线程经socketpair用tt_send/tt_close与tt_recv/tt_wait传输（写出时按比例丢弃），数据完整，
+ * 双方完成关闭，关闭后tt_recv返回TT_ERRFINAL；写回调失败时tt_send返回TT_ERRSEND，读回调失败时tt_recv返回TT_ERRRECV，
+ * 收到数据但回复ACK写出失败时tt_recv返回TT_ERRSEND
+ */
+
+#include "tt_test.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define LEN     (256 * 1024)
+#define MTU     1400
+
+static u8_t src[LEN], dst[LEN + 1];
+
+/* socketpair的一端，写出时按loss%整包丢弃 */
+typedef struct {
+    int         fd;
+    u32_t       loss;
+    unsigned    seed;
+} link_t;
+
+static s16_t fd_rcb(void* usr, u8_t* buf, s16_t len)
+{
+    link_t* l = (link_t*) usr;
+    struct pollfd pfd;
+    ssize_t n;
+
+    pfd.fd = l->fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 5) == 0) return 0;
+
+    n = read(l->fd, buf, (size_t) len);
+    return n > 0 ? (s16_t) n : -1;
+}
+
+static s16_t fd_wcb(void* usr, u8_t* buf, s16_t len)
+{
+    link_t* l = (link_t*) usr;
+
+    if ((u32_t) rand_r(&l->seed) % 100 < l->loss) return len;
+
+    return write(l->fd, buf, (size_t) len) == len ? len : -1;
+}
+
+static s16_t fail_cb(void* usr, u8_t* buf, s16_t len)
+{
+    (void) usr, (void) buf, (void) len;
+    return -1;
+}
+
+typedef struct {
+    tt_t*   tt;
+    s32_t   err;
+} sender_t;
+
+static void* sender(void* arg)
+{
+    sender_t* s = (sender_t*) arg;
+    u32_t off = 0, t;
+    s32_t r;
+
+    for (t = 0; off < LEN && t < 10000; ++t) {
+        r = tt_send(s->tt, src + off, (s32_t) (LEN - off), 10);
+        if (r < 0) {
+            s->err = r;
+            return 0;
+        }
+        off += (u32_t) r;
+    }
+    if (off < LEN) {
+        s->err = -100;
+        return 0;
+    }
+
+    for (t = 0; !tt_is_closed(s->tt) && t < 100; ++t) tt_close(s->tt, 20);
+
+    return 0;
+}
+
+static s32_t run(u32_t loss)
+{
+    tt_t a, b;
+    link_t la, lb;
+    sender_t s;
+    pthread_t th;
+    u32_t got = 0, t;
+    s32_t r;
+    int sv[2];
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    la.fd = sv[0];
+    la.loss = loss;
+    la.seed = 1;
+    lb.fd = sv[1];
+    lb.loss = loss;
+    lb.seed = 2;
+
+    CHECK(tt_init(&a, fd_rcb, fd_wcb, 16, MTU, 3, &la) == 0);
+    CHECK(tt_init(&b, fd_rcb, fd_wcb, 16, MTU, 3, &lb) == 0);
+
+    s.tt = &a;
+    s.err = 0;
+    CHECK(pthread_create(&th, 0, sender, &s) == 0);
+
+    /* 收完后继续接收直到对方关闭（dst多出的1字节保证len不为0） */
+    for (t = 0; !tt_is_closed(&b) && t < 10000; ++t) {
+        r = tt_recv(&b, dst + got, (s32_t) (sizeof(dst) - got), 100);
+        if (r < 0) break;
+        got += (u32_t) r;
+    }
+    CHECK(tt_is_closed(&b));
+    CHECK(tt_recv(&b, dst + got, (s32_t) (sizeof(dst) - got), 1) == TT_ERRFINAL);
+    /* 回复的FIN可能丢失，继续为对方重发的FIN回复 */
+    tt_wait(&b, 5);
+
+    CHECK(pthread_join(th, 0) == 0);
+    CHECK(s.err == 0);
+    CHECK(tt_is_closed(&a));
+    CHECK(got == LEN && memcmp(src, dst, LEN) == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+    close(sv[0]);
+    close(sv[1]);
+
+    return 0;
+}
+
+/* 读写回调出错时的返回值 */
+static s32_t test_errors(void)
+{
+    u8_t q[4 * MTU];
+    tt_test_peer p;
+    tt_t a, b;
+    s32_t n;
+
+    /* 写出失败 */
+    CHECK(tt_init(&a, tt_test_nocb, fail_cb, 16, MTU, 3, 0) == 0);
+    CHECK(tt_send(&a, src, LEN, 3) == TT_ERRSEND);
+    tt_deinit(&a);
+
+    /* 读出错 */
+    CHECK(tt_init(&b, fail_cb, tt_test_nocb, 16, MTU, 3, 0) == 0);
+    CHECK(tt_recv(&b, dst, LEN, 3) == TT_ERRRECV);
+    tt_deinit(&b);
+
+    /* 收到数据后回复ACK写出失败：数据包由无IO接口的a产生，经tt_test_rcb读入 */
+    memset(&p, 0, sizeof(p));
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 16, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_rcb, fail_cb, 16, MTU, 3, &p) == 0);
+    CHECK(tt_submit(&a, src, 2 * (MTU - TT_SZHDR)) == 0);
+    CHECK((n = tt_poll_output(&a, q, sizeof(q))) > 0);
+    memcpy(p.q, q, (u32_t) n);
+    p.qt = (u32_t) n;
+    p.peer = &a;
+    p.step = 1;
+    CHECK(tt_recv(&b, dst, LEN, 3) == TT_ERRSEND);
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    CHECK(run(0) == 0);
+    CHECK(run(5) == 0);
+    CHECK(test_errors() == 0);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/* 拥塞控制：默认tt_cc_aimd从TT_CWNDINIT个包开始慢启动，关闭后每轮发送整个窗口；
+ * 丢包下新包只在已发送的包少于拥塞窗口时发出，快速重传时窗口减半（每次恢复一次）、超时时降为1，数据完整
+ */
+
+#include "tt_test.h"
+#include "tt_cc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (256 * 1024)
+#define MTU     1000
+#define PL      (MTU - TT_SZHDR)
+
+static u8_t src[LEN], dst[LEN];
+
+/* 包装tt_cc_aimd，统计回调并检查降窗结果 */
+static u32_t nack, nloss, nto, nbad;
+
+static void rec_init(tt_t* tt)
+{
+    tt_cc_aimd.init(tt);
+}
+
+static void rec_ack(tt_t* tt, u32_t n, u32_t rtt)
+{
+    nack += n;
+    tt_cc_aimd.ack(tt, n, rtt);
+}
+
+static void rec_loss(tt_t* tt, u8_t timeout)
+{
+    u32_t w = tt->cwnd;
+
+    if (timeout) ++nto;
+    else ++nloss;
+
+    tt_cc_aimd.loss(tt, timeout);
+    if (tt->ssth != (w / 2 > TT_CWNDMIN ? w / 2 : TT_CWNDMIN)) ++nbad;
+    if (tt->cwnd != (timeout ? 1 : tt->ssth)) ++nbad;
+}
+
+static const tt_cc rec = {"rec", rec_init, rec_ack, rec_loss};
+
+/* 取出from所有待发送的包，按loss%丢弃后输入to，返回取出的包数 */
+static u32_t drain(tt_t* from, tt_t* to, u32_t loss)
+{
+    u8_t f[MTU];
+    u32_t n = 0;
+    s32_t r;
+
+    while ((r = tt_poll_output(from, f, sizeof(f))) > 0) {
+        ++n;
+        if ((u32_t) rand() % 100 >= loss) tt_input(to, f, (u32_t) r);
+    }
+
+    return n;
+}
+
+/* 无丢包时的前两轮：慢启动每确认一个包窗口加1 */
+static s32_t test_start(const tt_cc* cc, u32_t n0, u32_t n1)
+{
+    tt_t a, b;
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+    CHECK(a.cc == &tt_cc_aimd && a.cwnd == TT_CWNDINIT);
+    tt_set_cc(&a, cc);
+
+    CHECK(tt_submit(&a, src, 64 * PL) == 0);
+    tt_tick(&a, 1);
+    tt_tick(&b, 1);
+    CHECK(drain(&a, &b, 0) == n0);
+    CHECK(drain(&b, &a, 0) == 1);
+    CHECK(tt_acked(&a) == n0 * PL);
+    CHECK(!cc || a.cwnd == 2 * n0);
+    CHECK(drain(&a, &b, 0) == n1);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+/* 丢包下传输，中途链路中断一段时间（超时） */
+static s32_t test_loss(u32_t loss)
+{
+    tt_t a, b;
+    u32_t now = 0, got = 0, snt;
+
+    srand(7);
+    nack = nloss = nto = nbad = 0;
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 64, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 64, MTU, 3, 0) == 0);
+    tt_set_cc(&a, &rec);
+    CHECK(a.cwnd == TT_CWNDINIT);
+    CHECK(tt_submit(&a, src, LEN) == 0);
+
+    while (tt_acked(&a) < LEN || got < LEN) {
+        CHECK(now < 600000);
+        ++now;
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+
+        /* 新包只在已发送的包少于拥塞窗口时发出 */
+        snt = a.nsnt;
+        drain(&a, &b, now >= 500 && now < 2500 ? 100 : loss);
+        CHECK(a.nsnt <= snt || a.nsnt <= a.cwnd);
+
+        got += (u32_t) tt_read(&b, dst + got, (s32_t) (LEN - got));
+        drain(&b, &a, now >= 500 && now < 2500 ? 100 : loss);
+    }
+
+    CHECK(memcmp(src, dst, LEN) == 0);
+    CHECK(nack >= LEN / PL);
+    CHECK(nloss > 0 && nto > 0 && nbad == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    CHECK(test_start(&tt_cc_aimd, TT_CWNDINIT, 2 * TT_CWNDINIT) == 0);
+    /* 关闭后每轮发送整个窗口 */
+    CHECK(test_start(0, 32, 32) == 0);
+    CHECK(test_loss(5) == 0);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/* 快速重传阈值与提前重传：丢第一个包，逐个送达之后的包，第dupk个包的ACK到达时立即重发（不推进时间），
+ * tt_set_dupk(0)关闭；已发送的包不足dupk + 1个时提前重传降低阈值，tt_set_early(0)后不再降低；
+ * 每个包只快速重传一次，再次丢失后由超时重传恢复，数据完整
+ */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PL      (TT_SZPKT - TT_SZHDR)
+
+/* 包头flag的低2位为FIN、ACK，都为0时是数据包 */
+#define IS_DATA(f)  (!((f)[0] & 0x03))
+#define SEQ(f)      ((f)[1] << 8 | (f)[2])
+
+static u8_t src[16 * PL], dst[16 * PL];
+static u8_t q[16][TT_SZPKT];
+static s32_t ql[16];
+
+/* 取出from待发送的所有包，丢弃0号数据包，其余输入to，返回其中0号数据包的个数 */
+static u32_t drain(tt_t* from, tt_t* to)
+{
+    u8_t f[TT_SZPKT];
+    u32_t n0 = 0;
+    s32_t n;
+
+    while ((n = tt_poll_output(from, f, sizeof(f))) > 0) {
+        if (IS_DATA(f) && SEQ(f) == 0) {
+            ++n0;
+            continue;
+        }
+        tt_input(to, f, (u32_t) n);
+    }
+
+    return n0;
+}
+
+/* a一次发出npkt个包（不限拥塞窗口），0号包丢失，之后的包逐个送达并把ACK交给a，
+ * at为第几个包送达后a重发了0号包（0表示没有重发），重发的包同样丢失，之后不应再快速重传
+ */
+static s32_t first_resend(u16_t k, u8_t early, u32_t npkt, u32_t* at)
+{
+    u8_t f[TT_SZPKT];
+    tt_t a, b;
+    u32_t now = 1, got = 0, i, nr = 0;
+    s32_t n;
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    tt_set_cc(&a, 0);
+    tt_set_dupk(&a, k);
+    tt_set_early(&a, early);
+    tt_tick(&a, now);
+    tt_tick(&b, now);
+    CHECK(tt_submit(&a, src, npkt * PL) == 0);
+
+    /* 收集a发出的包，0号包丢弃 */
+    for (i = 0; (n = tt_poll_output(&a, f, sizeof(f))) > 0; ) {
+        CHECK(IS_DATA(f) && i < 16);
+        if (SEQ(f) == 0) continue;
+        memcpy(q[i], f, (u32_t) n);
+        ql[i++] = n;
+    }
+    CHECK(i == npkt - 1);
+
+    *at = 0;
+    for (i = 0; i < npkt - 1; ++i) {
+        tt_input(&b, q[i], (u32_t) ql[i]);
+        drain(&b, &a);
+        if (drain(&a, &b) && !nr++) *at = i + 1;
+    }
+    CHECK(nr <= 1);
+
+    /* 推进时间，超时重传恢复 */
+    for (; tt_acked(&a) < npkt * PL || got < npkt * PL; ++now) {
+        CHECK(now < 60000);
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+        tt_test_pump(&a, &b, 0, 0);
+        got += (u32_t) tt_read(&b, dst + got, (s32_t) (npkt * PL - got));
+        tt_test_pump(&b, &a, 0, 0);
+    }
+    CHECK(memcmp(src, dst, npkt * PL) == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i, at;
+
+    for (i = 0; i < sizeof(src); ++i) src[i] = (u8_t) (i * 7 + (i >> 8));
+
+    CHECK(first_resend(TT_DUPK, 1, 8, &at) == 0 && at == TT_DUPK);
+    CHECK(first_resend(TT_DUPK, 0, 8, &at) == 0 && at == TT_DUPK);
+    CHECK(first_resend(5, 1, 8, &at) == 0 && at == 5);
+    CHECK(first_resend(0, 1, 8, &at) == 0 && at == 0);
+
+    /* 只发出3个、2个包：提前重传把阈值降为已发送的包个数 - 1 */
+    CHECK(first_resend(TT_DUPK, 1, 3, &at) == 0 && at == 2);
+    CHECK(first_resend(TT_DUPK, 1, 2, &at) == 0 && at == 1);
+    CHECK(first_resend(TT_DUPK, 0, 3, &at) == 0 && at == 0);
+    CHECK(first_resend(TT_DUPK, 0, 2, &at) == 0 && at == 0);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/* 前向纠错：GF(256)区域乘加各实现与逐字节乘法一致；k个数据包编码m个校验包后，任意擦除不超过m个数据包都能解出；
+ * 开启tt_set_fec的连接在丢包下通过校验包恢复（不全靠重传）
+ */
+
+#include "tt_test.h"
+#include "tt_fec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define K       12
+#define PL      173
+
+static s32_t test_madd(void)
+{
+    static u8_t src[1500], dst[1500], ref[1500];
+    s32_t impl, def = tt_gf_impl();
+    u32_t c, off, i, n = 0;
+
+    for (i = 0; i < sizeof(src); ++i) src[i] = (u8_t) rand();
+
+    for (c = 1; c < 256; ++c) CHECK(tt_gf_mul((u8_t) c, tt_gf_inv((u8_t) c)) == 1);
+
+    for (impl = TT_GF_TAB; impl < TT_GF_AUTO; ++impl) {
+        if (tt_gf_select(impl) < 0) continue;
+        ++n;
+
+        for (c = 0; c < 256; c += 17) {
+            /* 起始地址与长度都不对齐 */
+            for (off = 0; off < 4; ++off) {
+                u32_t len = sizeof(src) - 7 - off;
+
+                for (i = 0; i < sizeof(dst); ++i) dst[i] = ref[i] = (u8_t) (i * 13);
+                for (i = 0; i < len; ++i) ref[off + i] ^= tt_gf_mul((u8_t) c, src[off + i]);
+
+                tt_gf_madd(dst + off, src + off, (u8_t) c, len);
+                CHECK(memcmp(dst, ref, sizeof(dst)) == 0);
+            }
+        }
+    }
+
+    CHECK(n >= 1);
+    CHECK(tt_gf_select(def) == def);
+
+    return 0;
+}
+
+/* 擦除lost中的ne个数据包，用前ne个校验包解出 */
+static s32_t decode(u8_t data[K][PL], u8_t par[TT_FECM][PL], const u32_t* lost, u32_t ne)
+{
+    u8_t a[TT_FECM * TT_FECM];
+    u8_t syn[TT_FECM][PL];
+    u32_t i, j, r;
+
+    /* 校验包减去未丢失数据包的贡献，剩下丢失包的线性组合 */
+    for (j = 0; j < ne; ++j) {
+        memcpy(syn[j], par[j], PL);
+        for (i = 0; i < K; ++i) {
+            for (r = 0; r < ne && lost[r] != i; ++r);
+            if (r == ne) tt_gf_madd(syn[j], data[i], tt_fec_coef(j, i), PL);
+        }
+        for (r = 0; r < ne; ++r) a[j * ne + r] = tt_fec_coef(j, lost[r]);
+    }
+
+    CHECK(tt_fec_inv(a, ne) == 0);
+
+    for (r = 0; r < ne; ++r) {
+        memset(data[lost[r]], 0, PL);
+        for (j = 0; j < ne; ++j) tt_gf_madd(data[lost[r]], syn[j], a[r * ne + j], PL);
+    }
+
+    return 0;
+}
+
+static s32_t test_erasure(void)
+{
+    static u8_t data[K][PL], orig[K][PL], par[TT_FECM][PL];
+    u32_t lost[TT_FECM];
+    u32_t i, j, r, t, ne;
+
+    for (t = 0; t < 200; ++t) {
+        for (i = 0; i < K; ++i) {
+            for (j = 0; j < PL; ++j) orig[i][j] = (u8_t) rand();
+        }
+
+        /* 编码：第j个校验包为各数据包按coef(j, i)的线性组合，第0行为异或 */
+        memset(par, 0, sizeof(par));
+        for (j = 0; j < TT_FECM; ++j) {
+            for (i = 0; i < K; ++i) tt_gf_madd(par[j], orig[i], tt_fec_coef(j, i), PL);
+        }
+        for (j = 0; j < PL; ++j) {
+            u8_t x = 0;
+            for (i = 0; i < K; ++i) x ^= orig[i][j];
+            CHECK(par[0][j] == x);
+        }
+
+        /* 随机擦除1~TT_FECM个不同的数据包 */
+        ne = 1 + t % TT_FECM;
+        for (r = 0; r < ne; ++r) {
+            u32_t k;
+            do {
+                lost[r] = (u32_t) rand() % K;
+                for (k = 0; k < r && lost[k] != lost[r]; ++k);
+            } while (k < r);
+        }
+
+        memcpy(data, orig, sizeof(data));
+        for (r = 0; r < ne; ++r) memset(data[lost[r]], 0xA5, PL);
+
+        CHECK(decode(data, par, lost, ne) == 0);
+        CHECK(memcmp(data, orig, sizeof(data)) == 0);
+    }
+
+    return 0;
+}
+
+/* 双方开启FEC，丢包时接收方通过校验包恢复一部分丢包 */
+static s32_t test_link(u8_t k, u8_t m)
+{
+    static u8_t src[64 * 1024], dst[64 * 1024];
+    tt_t a, b;
+    u32_t i;
+
+    srand(7);
+    for (i = 0; i < sizeof(src); ++i) src[i] = (u8_t) rand();
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 32, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 32, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_set_fec(&a, k, m) == 0);
+    CHECK(tt_set_fec(&b, k, m) == 0);
+
+    CHECK(tt_test_xfer(&a, &b, src, sizeof(src), dst, 5, 0, 60000) > 0);
+    CHECK(memcmp(src, dst, sizeof(src)) == 0);
+    CHECK(b.nfec > 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    CHECK(test_madd() == 0);
+    CHECK(test_erasure() == 0);
+    CHECK(test_link(8, 1) == 0);
+    CHECK(test_link(8, 2) == 0);
+
+    return 0;
+}
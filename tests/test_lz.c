@@ -0,0 +1,147 @@
+/* 负载压缩：文本、重复模式、随机、边界长度的数据压缩后能原样解出；不可压缩时放弃；损坏或截断的输入不越界；
+ * 开启tt_set_lz的连接数据完整送达，对方通告支持后才发送压缩包
+ */
+
+#include "tt_test.h"
+#include "tt_lz.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAXL    4096
+
+static u16_t tab[TT_LZ_HSZ];
+static u8_t src[MAXL], cmp[MAXL + 64], out[MAXL + 64];
+
+/* 压缩到不超过len - 1字节，能压缩时解压比较；返回压缩后长度（0为放弃），出错返回-1 */
+static s32_t round_trip(u32_t len)
+{
+    u32_t n = tt_lz_compress(tab, src, len, cmp, len ? len - 1 : 0);
+
+    if (n) {
+        CHECK(n < len);
+        CHECK(tt_lz_decompress(cmp, n, out, len) == (s32_t) len);
+        CHECK(memcmp(out, src, len) == 0);
+        /* 输出空间不足时报错而不是越界 */
+        CHECK(tt_lz_decompress(cmp, n, out, len - 1) < 0);
+    }
+
+    return (s32_t) n;
+}
+
+static void fill_text(u32_t len)
+{
+    static const char* w[] = { "temp=", "22.5", ",hum=", "41", ";", "pressure=", "1013", " ok\n" };
+    u32_t o = 0;
+    const char* p;
+
+    while (o < len) {
+        for (p = w[rand() % 8]; *p && o < len; ++p) src[o++] = (u8_t) *p;
+    }
+}
+
+static s32_t test_codec(void)
+{
+    u32_t len, i, t;
+    s32_t n;
+
+    /* 文本：应有明显收益 */
+    fill_text(1400);
+    n = round_trip(1400);
+    CHECK(n > 0 && n < 1400 * 2 / 3);
+
+    /* 全0与短周期重复（匹配与输出重叠），长匹配需要长度扩展字节 */
+    memset(src, 0, MAXL);
+    CHECK(round_trip(MAXL) > 0);
+    for (i = 0; i < MAXL; ++i) src[i] = (u8_t) "abc"[i % 3];
+    CHECK(round_trip(MAXL) > 0);
+
+    /* 随机数据不可压缩，放弃 */
+    for (i = 0; i < MAXL; ++i) src[i] = (u8_t) rand();
+    CHECK(round_trip(MAXL) == 0);
+
+    /* 长字面量后接匹配（字面量长度扩展） */
+    memcpy(src + 600, src, 600);
+    CHECK(round_trip(1200) > 0);
+
+    /* 各种长度，包括比最短匹配还短的 */
+    for (len = 1; len <= 300; ++len) {
+        for (t = 0; t < 4; ++t) {
+            if (t & 1) fill_text(len);
+            else for (i = 0; i < len; ++i) src[i] = (u8_t) (rand() % (t ? 4 : 256));
+            CHECK(round_trip(len) >= 0);
+        }
+    }
+
+    return 0;
+}
+
+/* 截断、改写的压缩数据：只要求返回错误或不超过cap的长度，不越界（配合ASan等检查） */
+static s32_t test_corrupt(void)
+{
+    u32_t n, i, t;
+    s32_t r;
+
+    fill_text(1400);
+    n = tt_lz_compress(tab, src, 1400, cmp, 1399);
+    CHECK(n > 0);
+
+    for (i = 0; i < n; ++i) {
+        r = tt_lz_decompress(cmp, i, out, 1400);
+        CHECK(r <= 1400);
+    }
+
+    for (t = 0; t < 2000; ++t) {
+        u8_t c[MAXL];
+
+        memcpy(c, cmp, n);
+        c[rand() % n] ^= (u8_t) (1 + rand() % 255);
+        r = tt_lz_decompress(c, n, out, 1400);
+        CHECK(r <= 1400);
+    }
+
+    return 0;
+}
+
+/* 传输可压缩与不可压缩交替的数据：双方开启时收到对方通告后开始压缩；只有发送方开启时（对方不通告）原样发送 */
+static s32_t test_link(u8_t peer)
+{
+    static u8_t data[64 * 1024], dst[64 * 1024];
+    tt_t a, b;
+    u32_t i;
+
+    for (i = 0; i < sizeof(data); i += 1400) {
+        u32_t l = sizeof(data) - i < 1400 ? sizeof(data) - i : 1400;
+        u32_t j;
+
+        fill_text(l);
+        if ((i / 1400) & 1) for (j = 0; j < l; ++j) src[j] = (u8_t) rand();
+        memcpy(data + i, src, l);
+    }
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_set_lz(&a, 1) == 0);
+    CHECK(tt_set_lz(&b, peer) == 0);
+
+    CHECK(tt_test_xfer(&a, &b, data, sizeof(data), dst, 3, 0, 60000) > 0);
+    CHECK(memcmp(data, dst, sizeof(data)) == 0);
+    CHECK(a.caps == (peer ? TT_CLZ : 0));
+    CHECK(peer ? a.zsave > 0 : a.zsave == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    CHECK(test_codec() == 0);
+    CHECK(test_corrupt() == 0);
+    CHECK(test_link(1) == 0);
+    CHECK(test_link(0) == 0);
+
+    return 0;
+}
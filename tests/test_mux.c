@@ -0,0 +1,132 @@
+/* 多路复用：4个通道共用一条字节流（丢包、翻转位、任意分段），各通道数据完整；
+ * 通道0开启接收窗口通告且不读取，不影响其他通道；自定义校验函数的通道按自己的校验分发；
+ * 未注册的cid被丢弃并计数
+ */
+
+#include "tt_test.h"
+#include "tt_mux.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NC      4
+#define LEN     (64 * 1024)
+#define MTU     1000
+
+static u8_t src[NC][LEN], dst[NC][LEN];
+static u8_t st[1 << 20];
+
+static u16_t xcrc(u16_t crc, const u8_t* data, u32_t len)
+{
+    if (crc == 0) crc = 0x5a5a;
+    while (len--) crc = (u16_t) ((crc << 3 | crc >> 13) ^ *data++);
+    return crc;
+}
+
+/* 取出from所有待发送的包，按loss%丢弃、按flip%翻转一位后拼成字节流，再按随机长度分段输入to */
+static void xfer(tt_mux* from, tt_mux* to, u32_t loss, u32_t flip)
+{
+    u8_t f[MTU];
+    u32_t sl = 0, o, k;
+    s32_t n;
+
+    while ((n = tt_mux_poll_output(from, f, sizeof(f))) > 0) {
+        if ((u32_t) rand() % 100 < loss) continue;
+        if ((u32_t) rand() % 100 < flip) f[rand() % n] ^= (u8_t) (1 << (rand() & 7));
+        if (sl + (u32_t) n > sizeof(st)) continue;
+        memcpy(st + sl, f, (u32_t) n);
+        sl += (u32_t) n;
+    }
+
+    for (o = 0; o < sl; o += k) {
+        k = 1 + (u32_t) rand() % 3000;
+        if (k > sl - o) k = sl - o;
+        tt_mux_input(to, st + o, k);
+    }
+}
+
+static s32_t run(u32_t loss, u32_t flip)
+{
+    tt_t a[NC], b[NC];
+    tt_mux ma, mb;
+    u32_t got[NC] = {0}, now = 0, c, done;
+
+    srand(3);
+
+    CHECK(tt_mux_init(&ma, NC, MTU) == 0);
+    CHECK(tt_mux_init(&mb, NC, MTU) == 0);
+
+    for (c = 0; c < NC; ++c) {
+        CHECK(tt_init(&a[c], tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+        CHECK(tt_init(&b[c], tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) == 0);
+        if (c == 0) {
+            CHECK(tt_set_rwnd(&a[c], 1) == 0);
+            CHECK(tt_set_rwnd(&b[c], 1) == 0);
+        }
+        if (c == NC - 1) {
+            tt_set_crc(&a[c], xcrc);
+            tt_set_crc(&b[c], xcrc);
+        }
+        CHECK(tt_mux_add(&ma, &a[c], (u16_t) c) == 0);
+        CHECK(tt_mux_add(&mb, &b[c], (u16_t) c) == 0);
+        CHECK(tt_submit(&a[c], src[c], LEN) == 0);
+    }
+    CHECK(tt_mux_add(&ma, &a[0], 0) == TT_ERRMEM);
+    CHECK(tt_mux_add(&ma, &a[0], NC) == TT_ERRMEM);
+
+    do {
+        CHECK(now < 600000);
+        ++now;
+        tt_mux_tick(&ma, now);
+        tt_mux_tick(&mb, now);
+
+        xfer(&ma, &mb, loss, flip);
+        /* 通道0不读取 */
+        for (c = 1; c < NC; ++c) got[c] += (u32_t) tt_read(&b[c], dst[c] + got[c], (s32_t) (LEN - got[c]));
+        xfer(&mb, &ma, loss, flip);
+
+        done = 1;
+        for (c = 1; c < NC; ++c) done &= tt_acked(&a[c]) == LEN && got[c] == LEN;
+    } while (!done);
+
+    for (c = 1; c < NC; ++c) CHECK(memcmp(src[c], dst[c], LEN) == 0);
+    /* 通道0停在对端的接收窗口上 */
+    CHECK(tt_acked(&a[0]) < LEN);
+    CHECK(ma.ndrop == 0 && mb.ndrop == 0);
+
+    /* 注销后该cid的包被丢弃，其他通道照常读取 */
+    tt_mux_del(&mb, 0);
+    got[0] = (u32_t) tt_read(&b[0], dst[0], LEN);
+    CHECK(got[0] > 0 && memcmp(src[0], dst[0], got[0]) == 0);
+    for (; now < 600000 && !mb.ndrop; ++now) {
+        tt_mux_tick(&ma, now);
+        tt_mux_tick(&mb, now);
+        xfer(&ma, &mb, 0, 0);
+        xfer(&mb, &ma, 0, 0);
+    }
+    CHECK(mb.ndrop > 0);
+
+    for (c = 0; c < NC; ++c) {
+        tt_deinit(&a[c]);
+        tt_deinit(&b[c]);
+    }
+    tt_mux_deinit(&ma);
+    tt_mux_deinit(&mb);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t c, i;
+
+    for (c = 0; c < NC; ++c) {
+        for (i = 0; i < LEN; ++i) src[c][i] = (u8_t) rand();
+    }
+
+    CHECK(run(0, 0) == 0);
+    CHECK(run(5, 1) == 0);
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/* 接收缓存池：两个连接共享一个池在丢包下全双工传输（不限制、单元数远小于两个窗口之和的上限、上限下开启FEC），
+ * 数据完整、不因池用完而卡住，deinit后单元全部归还；接收环只取2*mtu；块大小溢出32位时借用失败而不是少分配
+ */
+
+#include "tt_test.h"
+#include "tt_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (256 * 1024)
+#define MTU     1000
+
+static u8_t src[2][LEN], dst[2][LEN];
+
+static s32_t run(u32_t lim, u8_t fec, u32_t loss)
+{
+    tt_pool pool;
+    tt_t a, b;
+    u32_t now = 0, ga = 0, gb = 0;
+
+    srand(3);
+
+    CHECK(tt_pool_init(&pool, MTU - TT_SZHDR, lim, 16) == 0);
+    CHECK(tt_init_pool(&a, tt_test_nocb, tt_test_nocb, 64, MTU, 3, 0, &pool) == 0);
+    CHECK(tt_init_pool(&b, tt_test_nocb, tt_test_nocb, 64, MTU, 3, 0, &pool) == 0);
+    CHECK(a.rsz == 2048 && !a.buf);
+    if (fec) {
+        CHECK(tt_set_fec(&a, 8, 2) == 0);
+        CHECK(tt_set_fec(&b, 8, 2) == 0);
+    }
+
+    CHECK(tt_submit(&a, src[0], LEN) == 0);
+    CHECK(tt_submit(&b, src[1], LEN) == 0);
+
+    while (tt_acked(&a) < LEN || tt_acked(&b) < LEN || gb < LEN || ga < LEN) {
+        if (now >= 600000) {
+            fprintf(stderr, "lim %u fec %u: %u/%u %u/%u after %u ms\n", lim, fec, gb, ga, tt_acked(&a), tt_acked(&b), now);
+            return 1;
+        }
+
+        ++now;
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+
+        tt_test_pump(&a, &b, loss, 0);
+        /* b读得慢，数据在池中积压 */
+        gb += (u32_t) tt_read(&b, dst[0] + gb, now & 3 ? 0 : (s32_t) (LEN - gb));
+        tt_test_pump(&b, &a, loss, 0);
+        ga += (u32_t) tt_read(&a, dst[1] + ga, (s32_t) (LEN - ga));
+    }
+
+    CHECK(memcmp(src[0], dst[0], LEN) == 0);
+    CHECK(memcmp(src[1], dst[1], LEN) == 0);
+    CHECK(!lim || pool.npeak <= lim);
+    CHECK(pool.nget > 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+    CHECK(pool.nused == 0);
+    tt_pool_deinit(&pool);
+
+    return 0;
+}
+
+static s32_t test_overflow(void)
+{
+    tt_pool pool;
+
+    /* 64个256MB的单元，块大小超出32位 */
+    CHECK(tt_pool_init(&pool, 0x10000000, 0, 64) == 0);
+    CHECK(tt_pool_get(&pool, 1) == 0);
+    CHECK(pool.nfail == 1 && pool.nall == 0);
+    tt_pool_deinit(&pool);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i;
+
+    for (i = 0; i < LEN; ++i) {
+        src[0][i] = (u8_t) rand();
+        src[1][i] = (u8_t) rand();
+    }
+
+    CHECK(run(0, 0, 10) == 0);
+    CHECK(run(64, 0, 10) == 0);
+    CHECK(run(64, 1, 10) == 0);
+    CHECK(run(16, 0, 10) == 0);
+    CHECK(test_overflow() == 0);
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+/* 反应器：2000对socketpair连接（每个连接分两次提交，第二次追加在第一次确认之前）同时传输后关闭，
+ * 各自独立的窗口缓存与共享的接收缓存池两种方式，数据完整、接收环只取2*mtu；
+ * 对端关闭fd后只报告一次TT_EV_ERROR，之后tt_reactor_run不再因该fd空转
+ */
+
+#include "tt_test.h"
+#include "tt_reactor.h"
+#include "tt_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#define NL      2000
+#define SZ      (16 * 1024)
+#define MTU     1400
+
+static u8_t src[SZ];
+static tt_link lk[2 * NL];
+static u8_t* dst[NL];
+static u32_t got[NL];
+static u32_t nsent, nclosed, ndone, nerr;
+
+static void on_event(tt_link* l, s32_t ev, const u8_t* buf, u32_t len)
+{
+    u32_t id = (u32_t) (size_t) l->usr;
+
+    switch (ev) {
+    case TT_EV_DATA:
+        if (id < NL || got[id - NL] + len > SZ) {
+            ++nerr;
+            break;
+        }
+        memcpy(dst[id - NL] + got[id - NL], buf, len);
+        got[id - NL] += len;
+        ndone += got[id - NL] == SZ;
+        break;
+    case TT_EV_SENT:
+        ++nsent;
+        tt_link_close(l);
+        break;
+    case TT_EV_CLOSED:
+        ++nclosed;
+        break;
+    default:
+        fprintf(stderr, "link %u: event %d\n", id, ev);
+        ++nerr;
+    }
+}
+
+static void on_eof(tt_link* l, s32_t ev, const u8_t* buf, u32_t len)
+{
+    (void) l, (void) buf, (void) len;
+    nerr += ev == TT_EV_ERROR;
+}
+
+static u32_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u32_t) ts.tv_sec * 1000 + (u32_t) (ts.tv_nsec / 1000000);
+}
+
+static s32_t run(u32_t nl, tt_pool* pool)
+{
+    tt_reactor r;
+    u32_t i, it, t0;
+    int sv[2];
+
+    nsent = nclosed = ndone = nerr = 0;
+
+    CHECK(tt_reactor_init(&r) == 0);
+    r.pool = pool;
+
+    for (i = 0; i < nl; ++i) {
+        CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        got[i] = 0;
+        CHECK(tt_link_open(&r, &lk[i], sv[0], 16, MTU, on_event, (void*) (size_t) i) == 0);
+        CHECK(tt_link_open(&r, &lk[NL + i], sv[1], 16, MTU, on_event, (void*) (size_t) (NL + i)) == 0);
+    }
+    CHECK(lk[0].tt.rsz == 4096);
+
+    for (i = 0; i < nl; ++i) {
+        CHECK(tt_link_send(&lk[i], src, SZ / 3) == 0);
+        CHECK(tt_link_send(&lk[i], src + SZ / 3, SZ - SZ / 3) == 0);
+    }
+
+    t0 = now_ms();
+    for (it = 0; nclosed < 2 * nl && !nerr; ++it) {
+        CHECK(now_ms() - t0 < 60000);
+        CHECK(tt_reactor_run(&r, 100) >= 0);
+    }
+
+    CHECK(!nerr && nsent == nl && ndone == nl);
+    for (i = 0; i < nl; ++i) CHECK(memcmp(dst[i], src, SZ) == 0);
+
+    for (i = 0; i < nl; ++i) {
+        close(lk[i].fd);
+        close(lk[NL + i].fd);
+        tt_link_remove(&lk[i]);
+        tt_link_remove(&lk[NL + i]);
+    }
+    tt_reactor_deinit(&r);
+
+    return 0;
+}
+
+static s32_t test_eof(void)
+{
+    tt_reactor r;
+    u32_t t0, i;
+    s32_t n = 0, rt;
+    int sv[2];
+
+    nerr = 0;
+
+    CHECK(tt_reactor_init(&r) == 0);
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    CHECK(tt_link_open(&r, &lk[0], sv[0], 8, TT_SZPKT, on_eof, 0) == 0);
+    close(sv[1]);
+
+    t0 = now_ms();
+    for (i = 0; i < 5; ++i) {
+        rt = tt_reactor_run(&r, 50);
+        CHECK(rt >= 0);
+        n += rt;
+    }
+
+    CHECK(n == 1 && nerr == 1);
+    CHECK(now_ms() - t0 >= 200);
+
+    tt_link_remove(&lk[0]);
+    close(sv[0]);
+    tt_reactor_deinit(&r);
+
+    return 0;
+}
+
+int main(void)
+{
+    struct rlimit rl;
+    tt_pool pool;
+    u32_t i, nl = NL;
+
+    for (i = 0; i < SZ; ++i) src[i] = (u8_t) rand();
+    for (i = 0; i < NL; ++i) CHECK((dst[i] = malloc(SZ)) != 0);
+
+    /* 每对连接2个fd，按进程的fd上限缩小规模 */
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+        if (rl.rlim_cur < 2u * NL + 64) nl = (u32_t) (rl.rlim_cur - 64) / 2;
+    }
+
+    CHECK(run(nl, 0) == 0);
+
+    CHECK(tt_pool_init(&pool, MTU - TT_SZHDR, 0, 0) == 0);
+    CHECK(run(nl, &pool) == 0);
+    CHECK(pool.nused == 0 && pool.npeak > 0);
+    tt_pool_deinit(&pool);
+
+    CHECK(test_eof() == 0);
+
+    for (i = 0; i < NL; ++i) free(dst[i]);
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* 接收窗口通告：接收方读得慢时，开启通告的发送方几乎不重发（不开启时对方丢弃窗口外的包，重发大幅增加），
+ * 新包不超出对方通告的右边沿（对方窗口比本端小时同样成立）；对方停止读取时只按退避间隔发送窗口探测，
+ * 恢复读取后主动通告窗口打开，传输完成且数据完整
+ */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (128 * 1024)
+#define MTU     1000
+
+static u8_t src[LEN], dst[LEN];
+
+/* 取出from所有待发送的包，按loss%丢弃后输入to，返回取出的字节数 */
+static u32_t drain(tt_t* from, tt_t* to, u32_t loss)
+{
+    u8_t f[MTU];
+    u32_t n = 0;
+    s32_t r;
+
+    while ((r = tt_poll_output(from, f, sizeof(f))) > 0) {
+        n += (u32_t) r;
+        if ((u32_t) rand() % 100 >= loss) tt_input(to, f, (u32_t) r);
+    }
+
+    return n;
+}
+
+/* b（窗口nb）每10毫秒只读一个包，返回a发出的字节数，失败返回0 */
+static u32_t run(u8_t rwnd, u16_t nb, u32_t loss)
+{
+    tt_t a, b;
+    u32_t now = 0, got = 0, n = 0, pl;
+
+    srand(9);
+
+    if (tt_init(&a, tt_test_nocb, tt_test_nocb, 32, MTU, 3, 0) != 0) return 0;
+    if (tt_init(&b, tt_test_nocb, tt_test_nocb, nb, MTU, 3, 0) != 0) return 0;
+    if (tt_set_rwnd(&a, rwnd) != 0 || tt_set_rwnd(&b, rwnd) != 0) return 0;
+    if (tt_submit(&a, src, LEN) != 0) return 0;
+    pl = (u32_t) (MTU - b.hsz);
+
+    while (tt_acked(&a) < LEN || got < LEN) {
+        if (now >= 600000) {
+            fprintf(stderr, "rwnd %u nb %u: %u/%u after %u ms\n", rwnd, nb, got, tt_acked(&a), now);
+            return 0;
+        }
+
+        ++now;
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+
+        n += drain(&a, &b, loss);
+        /* 新包不超出对方通告的右边沿 */
+        if (rwnd && (s32_t) (a.rwr - a.seq - a.nsnt) < 0) {
+            fprintf(stderr, "rwnd nb %u: sent past the window at %u ms\n", nb, now);
+            return 0;
+        }
+
+        if (now % 10 == 0) got += (u32_t) tt_read(&b, dst + got, (s32_t) (LEN - got < pl ? LEN - got : pl));
+        drain(&b, &a, loss);
+    }
+
+    if (memcmp(src, dst, LEN)) {
+        fprintf(stderr, "rwnd %u nb %u: data mismatch\n", rwnd, nb);
+        return 0;
+    }
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return n;
+}
+
+/* b停止读取10秒：窗口填满后a只发送退避的窗口探测，b读取后主动通告窗口打开 */
+static s32_t test_stall(void)
+{
+    tt_t a, b;
+    u32_t now = 0, got = 0, n = 0, pl;
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 16, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, MTU, 3, 0) == 0);
+    CHECK(tt_set_rwnd(&a, 1) == 0 && tt_set_rwnd(&b, 1) == 0);
+    CHECK(tt_submit(&a, src, LEN) == 0);
+    pl = (u32_t) (MTU - a.hsz);
+
+    for (now = 1; now <= 10000; ++now) {
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+        n += drain(&a, &b, 0);
+        drain(&b, &a, 0);
+    }
+
+    /* 窗口填满后只有探测包（间隔指数退避，10秒内不到16个） */
+    CHECK(tt_acked(&a) == 16 * pl);
+    CHECK(n > 16 * MTU && a.wnum > 0 && a.wnum < 16);
+
+    /* 读出全部数据后不等探测，b主动通告窗口打开 */
+    got = (u32_t) tt_read(&b, dst, LEN);
+    CHECK(got == 16 * pl);
+    drain(&b, &a, 0);
+    CHECK((s32_t) (a.rwr - a.seq) > 0);
+    CHECK(drain(&a, &b, 0) > 0);
+
+    for (; tt_acked(&a) < LEN || got < LEN; ++now) {
+        CHECK(now < 600000);
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+        drain(&a, &b, 0);
+        got += (u32_t) tt_read(&b, dst + got, (s32_t) (LEN - got));
+        drain(&b, &a, 0);
+    }
+    CHECK(memcmp(src, dst, LEN) == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i, n0, n1;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    CHECK((n0 = run(0, 32, 0)) > 0);
+    CHECK((n1 = run(1, 32, 0)) > 0);
+    /* 不开启时窗口外的包被丢弃后重发 */
+    CHECK(n1 < LEN + LEN / 10 && n0 > n1 + n1 / 2);
+
+    CHECK(run(1, 8, 0) > 0);
+    CHECK(run(1, 32, 10) > 0);
+    CHECK(run(1, 8, 10) > 0);
+
+    CHECK(test_stall() == 0);
+
+    return 0;
+}
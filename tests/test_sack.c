@@ -0,0 +1,68 @@
+/* SACK：窗口内丢一个数据包，之后的包由位图确认，只重发丢失的那一个包 */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define NPKT    40
+#define PL      (TT_SZPKT - TT_SZHDR)
+#define LOST    5
+
+/* 包头flag的低2位为FIN、ACK，都为0时是数据包 */
+#define IS_DATA(f)  (!((f)[0] & 0x03))
+#define SEQ(f)      ((f)[1] << 8 | (f)[2])
+
+int main(void)
+{
+    static u8_t src[NPKT * PL], dst[NPKT * PL];
+    static u32_t ntx[NPKT];
+    tt_t a, b;
+    u8_t f[TT_SZPKT];
+    u32_t now = 0, got = 0, i, steps;
+    u8_t lost = 0;
+    s32_t n;
+
+    for (i = 0; i < sizeof(src); ++i) src[i] = (u8_t) (i * 7 + (i >> 8));
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, TT_SZPKT, 3, 0) == 0);
+    CHECK(tt_submit(&a, src, sizeof(src)) == 0);
+
+    for (steps = 0; (tt_acked(&a) < sizeof(src) || got < sizeof(src)) && steps < 100000; ++steps) {
+        ++now;
+        tt_tick(&a, now);
+        tt_tick(&b, now);
+
+        while ((n = tt_poll_output(&a, f, sizeof(f))) > 0) {
+            if (IS_DATA(f)) {
+                CHECK(SEQ(f) < NPKT);
+                ++ntx[SEQ(f)];
+                /* 只丢第一次发送的LOST号包 */
+                if (SEQ(f) == LOST && !lost) {
+                    lost = 1;
+                    continue;
+                }
+            }
+            tt_input(&b, f, (u32_t) n);
+        }
+
+        got += (u32_t) tt_read(&b, dst + got, (s32_t) (sizeof(dst) - got));
+
+        while ((n = tt_poll_output(&b, f, sizeof(f))) > 0) tt_input(&a, f, (u32_t) n);
+    }
+
+    CHECK(got == sizeof(src));
+    CHECK(memcmp(src, dst, sizeof(src)) == 0);
+    CHECK(lost);
+
+    for (i = 0; i < NPKT; ++i) {
+        if (ntx[i] != (i == LOST ? 2u : 1u)) fprintf(stderr, "packet %u sent %u times\n", i, ntx[i]);
+        CHECK(ntx[i] == (i == LOST ? 2u : 1u));
+    }
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+/* 无IO接口（tt_submit/tt_input/tt_poll_output/tt_tick）：185字节mtu的字节流链路上同时丢包、比特翻转、拆分输入，
+ * 数据完整送达，且包长字段被破坏后接收端能在限定时间内重新同步（不卡在半个帧上）
+ */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (64 * 1024)
+#define MTU     185
+#define TMAX    10000   /* 模拟时间上限（毫秒），重新同步正常时远小于该值 */
+
+static u8_t src[LEN], dst[LEN];
+
+static s32_t run(u32_t seed, u32_t loss, u32_t flip)
+{
+    tt_t a, b;
+    s32_t t;
+
+    srand(seed);
+
+    CHECK(tt_init(&a, tt_test_nocb, tt_test_nocb, 8, MTU, 3, 0) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 8, MTU, 3, 0) == 0);
+
+    t = tt_test_xfer(&a, &b, src, LEN, dst, loss, flip, TMAX);
+    if (t < 0) fprintf(stderr, "seed %u loss %u flip %u\n", seed, loss, flip);
+    CHECK(t > 0);
+    CHECK(memcmp(src, dst, LEN) == 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i, seed;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    CHECK(run(1, 0, 0) == 0);
+    for (seed = 1; seed <= 20; ++seed) {
+        CHECK(run(seed, 5, 0) == 0);
+        CHECK(run(seed, 0, 5) == 0);
+        CHECK(run(seed, 5, 5) == 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* 阻塞发送：开启负载探测的连接在丢包链路上tt_send多次返回不足len（超时后负载减半），
+ * 调用者从返回处重新传入剩余数据，对端收到的数据与原数据一致
+ */
+
+#include "tt_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN     (256 * 1024)
+#define MTU     1400
+
+static u8_t src[LEN], dst[LEN];
+static tt_test_peer p;
+
+static s32_t run(u32_t seed, u32_t loss)
+{
+    tt_t a, b;
+    u32_t off = 0, nshort = 0, t;
+    s32_t r;
+
+    srand(seed);
+    memset(&p, 0, sizeof(p));
+    p.peer = &b;
+    p.step = 10;
+    p.loss = loss;
+    p.out = dst;
+    p.cap = LEN;
+
+    CHECK(tt_init(&a, tt_test_rcb, tt_test_wcb, 16, MTU, 3, &p) == 0);
+    CHECK(tt_init(&b, tt_test_nocb, tt_test_nocb, 16, MTU, 3, 0) == 0);
+    tt_set_clock(&a, tt_test_clk);
+    tt_set_probe(&a, 1);
+
+    for (t = 0; off < LEN && t < 100000; ++t) {
+        r = tt_send(&a, src + off, (s32_t) (LEN - off), 2);
+        CHECK(r >= 0 && (u32_t) r <= LEN - off);
+        if ((u32_t) r < LEN - off) ++nshort;
+        off += (u32_t) r;
+    }
+
+    CHECK(off == LEN);
+    CHECK(p.nout == LEN);
+    if (memcmp(src, dst, LEN)) fprintf(stderr, "seed %u loss %u: data mismatch\n", seed, loss);
+    CHECK(memcmp(src, dst, LEN) == 0);
+    /* 确实走到了返回不足len、重新传入的路径 */
+    CHECK(nshort > 0);
+
+    tt_deinit(&a);
+    tt_deinit(&b);
+
+    return 0;
+}
+
+int main(void)
+{
+    u32_t i, seed;
+
+    for (i = 0; i < LEN; ++i) src[i] = (u8_t) rand();
+
+    for (seed = 1; seed <= 10; ++seed) CHECK(run(seed, 20) == 0);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/* C++封装：同一程序中两种配置（185字节串口、1400字节UDP）的session并存，窗口缓存按mtu计算（可放在栈上），
+ * 自定义校验策略经tt_set_crc生效，丢包下通过submit/input/poll_output/tick完整传输，recv_zc借出的lease只能移动、析构时归还
+ */
+
+extern "C" {
+#include "tt_test.h"
+#include "tt_crc.h"
+}
+
+#include "tt_session.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* 与tt_crc16结果相同，统计调用次数 */
+static u32_t ncrc;
+
+struct crc_count {
+    static u16_t update(u16_t crc, const u8_t* data, u32_t len)
+    {
+        ++ncrc;
+        return tt_crc16(crc, data, len);
+    }
+
+    static constexpr tt_crcfn fn = update;
+};
+
+using serial = tt::session<8, 185, crc_count>;
+using udp = tt::session<16, 1400>;
+
+static_assert(serial::max_payload == 185 - TT_SZHDR);
+static_assert(serial::ring == 512 && udp::ring == 4096);
+static_assert(serial::mem_size == TT_MEMSZ(8, 185, 512));
+static_assert(sizeof(serial) < 4096);
+
+template <class S>
+static int xfer(S& a, S& b, const std::vector<u8_t>& src, std::vector<u8_t>& dst, u32_t loss)
+{
+    std::vector<u8_t> f(S::mtu);
+    u32_t now = 0, got = 0;
+    s32_t n;
+
+    CHECK(a.submit(src) == 0);
+
+    while (tt_acked(a.get()) < src.size() || got < src.size()) {
+        CHECK(now < 60000);
+        ++now;
+        a.tick(now);
+        b.tick(now);
+
+        while ((n = a.poll_output(f)) > 0) {
+            if ((u32_t) rand() % 100 >= loss) b.input({f.data(), (std::size_t) n});
+        }
+        got += (u32_t) b.read({dst.data() + got, src.size() - got});
+        while ((n = b.poll_output(f)) > 0) {
+            if ((u32_t) rand() % 100 >= loss) a.input({f.data(), (std::size_t) n});
+        }
+    }
+
+    CHECK(dst == src);
+
+    return 0;
+}
+
+template <class S>
+static int test_xfer(u32_t len)
+{
+    S a(tt_test_nocb, tt_test_nocb, 3, nullptr);
+    S b(tt_test_nocb, tt_test_nocb, 3, nullptr);
+    std::vector<u8_t> src(len), dst(len);
+
+    for (auto& c : src) c = (u8_t) rand();
+
+    CHECK(a.get()->mtu == S::mtu && a.get()->nwnd == S::window);
+    CHECK(xfer(a, b, src, dst, 5) == 0);
+
+    return 0;
+}
+
+/* 数据已在b的接收缓存中时recv_zc直接借出 */
+static int test_lease()
+{
+    serial a(tt_test_nocb, tt_test_nocb, 3, nullptr);
+    serial b(tt_test_nocb, tt_test_nocb, 3, nullptr);
+    std::vector<u8_t> src(3 * serial::max_payload), f(serial::mtu);
+    u32_t now = 0;
+    s32_t n;
+
+    for (auto& c : src) c = (u8_t) rand();
+    CHECK(a.submit(src) == 0);
+
+    /* 只输入不读取，数据留在b的接收缓存中 */
+    while (tt_acked(a.get()) < src.size()) {
+        CHECK(++now < 10000);
+        a.tick(now);
+        b.tick(now);
+        while ((n = a.poll_output(f)) > 0) b.input({f.data(), (std::size_t) n});
+        while ((n = b.poll_output(f)) > 0) a.input({f.data(), (std::size_t) n});
+    }
+
+    auto l = b.recv_zc<8>(1);
+    CHECK(l.size() == 3 && l.bytes() == src.size());
+    for (std::size_t i = 0, off = 0; i < l.size(); off += l[i].size(), ++i) {
+        CHECK(std::memcmp(l[i].data(), src.data() + off, l[i].size()) == 0);
+    }
+
+    /* 移动后原对象为空，只由新对象归还一次 */
+    auto m = std::move(l);
+    CHECK(l.empty() && m.bytes() == src.size());
+    m.release();
+    CHECK(m.empty());
+
+    CHECK(b.read({f.data(), f.size()}) == 0);
+
+    return 0;
+}
+
+int main()
+{
+    /* 两个窗口缓存都在栈上 */
+    CHECK(test_xfer<serial>(32 * 1024) == 0);
+    CHECK(ncrc > 0);
+    CHECK(test_xfer<udp>(256 * 1024) == 0);
+    CHECK(test_lease() == 0);
+
+    return 0;
+}
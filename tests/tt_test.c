@@ -0,0 +1,100 @@
+#include "tt_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+s16_t tt_test_nocb(void* usr, u8_t* buf, s16_t len)
+{
+    (void) usr, (void) buf, (void) len;
+    return 0;
+}
+
+void tt_test_pump(tt_t* from, tt_t* to, u32_t loss, u32_t flip)
+{
+    u8_t f[0x7fff];
+    s32_t n, h;
+
+    while ((n = tt_poll_output(from, f, sizeof(f))) > 0) {
+        if ((u32_t) rand() % 100 < loss) continue;
+        if ((u32_t) rand() % 100 < flip) f[rand() % n] ^= (u8_t) (1 << (rand() & 7));
+
+        h = rand() % (n + 1);
+        tt_input(to, f, (u32_t) h);
+        tt_input(to, f + h, (u32_t) (n - h));
+    }
+}
+
+s32_t tt_test_xfer(tt_t* a, tt_t* b, const u8_t* src, u32_t len, u8_t* dst, u32_t loss, u32_t flip, u32_t tmax)
+{
+    u32_t now = 0, got = 0;
+
+    if (tt_submit(a, src, len) < 0) return -1;
+
+    while (tt_acked(a) < len || got < len) {
+        if (now >= tmax) {
+            fprintf(stderr, "xfer: %u/%u bytes after %u ms\n", got, len, now);
+            return -1;
+        }
+
+        ++now;
+        tt_tick(a, now);
+        tt_tick(b, now);
+
+        tt_test_pump(a, b, loss, flip);
+        got += (u32_t) tt_read(b, dst + got, (s32_t) (len - got));
+        tt_test_pump(b, a, loss, flip);
+    }
+
+    return (s32_t) now;
+}
+
+/* 对端读出收到的数据，待发送的包按丢包率放入q（放不下的也当作丢失） */
+static void peer_drain(tt_test_peer* p)
+{
+    u8_t f[0x7fff];
+    s32_t n;
+
+    if (p->nout < p->cap) p->nout += (u32_t) tt_read(p->peer, p->out + p->nout, (s32_t) (p->cap - p->nout));
+    if (p->cut && p->nout >= p->cut) p->loss = 100;
+
+    if (p->qh == p->qt) p->qh = p->qt = 0;
+    while ((n = tt_poll_output(p->peer, f, sizeof(f))) > 0) {
+        if ((u32_t) rand() % 100 < p->loss || p->qt + (u32_t) n > sizeof(p->q)) continue;
+        memcpy(p->q + p->qt, f, (u32_t) n);
+        p->qt += (u32_t) n;
+    }
+}
+
+s16_t tt_test_rcb(void* usr, u8_t* buf, s16_t len)
+{
+    tt_test_peer* p = (tt_test_peer*) usr;
+    u32_t n;
+
+    if (p->qh == p->qt) {
+        p->now += p->step;
+        tt_tick(p->peer, p->now);
+        peer_drain(p);
+        if (p->qh == p->qt) return 0;
+    }
+
+    n = p->qt - p->qh < (u32_t) len ? p->qt - p->qh : (u32_t) len;
+    memcpy(buf, p->q + p->qh, n);
+    p->qh += n;
+
+    return (s16_t) n;
+}
+
+s16_t tt_test_wcb(void* usr, u8_t* buf, s16_t len)
+{
+    tt_test_peer* p = (tt_test_peer*) usr;
+
+    if ((u32_t) rand() % 100 >= p->loss) tt_input(p->peer, buf, (u32_t) len);
+    peer_drain(p);
+
+    return len;
+}
+
+u32_t tt_test_clk(void* usr)
+{
+    return ((tt_test_peer*) usr)->now;
+}
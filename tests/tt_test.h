@@ -0,0 +1,44 @@
+#ifndef _TT_TEST_H_
+#define _TT_TEST_H_
+
+/* tests/下各测试共用的检查宏与收发驱动（实现在tt_test.c，由run.sh与各测试一起编译） */
+
+#include "tt.h"
+
+#include <stdio.h>
+
+/* 条件不成立时输出位置并使当前函数返回1 */
+#define CHECK(c) do { if (!(c)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #c); return 1; } } while (0)
+
+/* 不使用的读写回调（无IO接口驱动的连接） */
+s16_t tt_test_nocb(void* usr, u8_t* buf, s16_t len);
+
+/* 取出from待发送的所有包，每个包按loss%丢弃、按flip%翻转一位，剩余的拆成随机的两段输入to */
+void tt_test_pump(tt_t* from, tt_t* to, u32_t loss, u32_t flip);
+
+/* 以1毫秒为步长驱动a、b（双向都经tt_test_pump），a提交src[0..len)，b读到dst中，
+ * 全部确认且读完后返回所用的模拟时间（毫秒），tmax毫秒内未完成返回-1
+ */
+s32_t tt_test_xfer(tt_t* a, tt_t* b, const u8_t* src, u32_t len, u8_t* dst, u32_t loss, u32_t flip, u32_t tmax);
+
+/* 阻塞接口（tt_send/tt_recv等）的对端：对端是无IO接口驱动的连接，在本端的读写回调中同步推进（单线程，结果可重现）。
+ * 本端以tt_test_rcb/tt_test_wcb为读写回调、tt_test_clk为时钟，usr指向该结构
+ */
+typedef struct {
+    tt_t*   peer;
+    u32_t   now;        /* 模拟时间（毫秒），本端读不到数据时前进step */
+    u32_t   step;
+    u32_t   loss;       /* 两个方向的丢包率（%） */
+    u32_t   cut;        /* 对端收到这么多字节后链路中断（两个方向全部丢弃），0为不中断 */
+    u8_t*   out;        /* 对端收到的数据 */
+    u32_t   nout;
+    u32_t   cap;
+    u32_t   qh, qt;     /* q中待本端读取的字节 */
+    u8_t    q[0x10000];
+} tt_test_peer;
+
+s16_t tt_test_rcb(void* usr, u8_t* buf, s16_t len);
+s16_t tt_test_wcb(void* usr, u8_t* buf, s16_t len);
+u32_t tt_test_clk(void* usr);
+
+#endif // _TT_TEST_H_
@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "tt_async.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/* 队列空/非空的判断与idle标志之间需要全序（Dekker式）：
+ * 引擎线程先置idle再检查tail，应用线程先写tail再检查idle，二者都用SEQ_CST，不会都看不到对方的写入。
+ */
+#define TT_LOAD(p)          __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define TT_STORE(p, x)      __atomic_store_n(p, x, __ATOMIC_RELEASE)
+#define TT_LOAD_SC(p)       __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define TT_STORE_SC(p, x)   __atomic_store_n(p, x, __ATOMIC_SEQ_CST)
+
+static void fd_add(int fd)
+{
+    uint64_t v = 1;
+    ssize_t rt;
+
+    rt = write(fd, &v, sizeof(v));
+    (void) rt;
+}
+
+static u32_t as_now(tt_t* tt)
+{
+    struct timespec ts;
+
+    if (tt->clk) return tt->clk(tt->usr);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u32_t) ts.tv_sec * 1000 + (u32_t) (ts.tv_nsec / 1000000);
+}
+
+/* 以rt完成最早未完成的请求（未提交的也一并跳过） */
+static void as_done(tt_async* as, s32_t rt)
+{
+    u32_t i = as->done;
+    tt_asreq* rq = as->q + (i & (as->qsz - 1));
+
+    rq->rt = rt;
+    if (as->sub == i) as->sub = i + 1;
+
+    TT_STORE(&as->done, i + 1);
+
+    /* 有回调时由引擎线程空出槽位，否则等应用线程取回结果 */
+    if (as->cb) {
+        as->cb(rq->ctx, rq->buf, rq->rt);
+        TT_STORE(&as->head, i + 1);
+    }
+
+    fd_add(as->efd);
+}
+
+/* 数据流中断：最早未完成的请求以rt完成，之后的请求都以TT_ERRSEND完成 */
+static void as_fail(tt_async* as, s32_t rt)
+{
+    TT_STORE(&as->err, 1);
+    as_done(as, rt);
+}
+
+/* 写出协议核心待发送的所有包 */
+static s32_t as_flush(tt_async* as)
+{
+    tt_t* tt = as->tt;
+    s32_t n;
+
+    while ((n = tt_poll_output(tt, as->io, tt->mtu)) > 0) {
+        if (tt->wcb(tt->usr, as->io, (s16_t) n) != n) return TT_ERRSEND;
+    }
+
+    return 0;
+}
+
+static void* as_run(void* arg)
+{
+    tt_async* as = arg;
+    tt_t* tt = as->tt;
+    tt_asreq* rq;
+    uint64_t v;
+    ssize_t rt;
+    s32_t n;
+    u32_t t;
+
+    for (;;) {
+        t = TT_LOAD_SC(&as->tail);
+
+        /* 按提交顺序完成已全部确认的请求（须在提交新请求之前：全部确认后tt_submit从0重新累计） */
+        while (as->done != as->sub) {
+            rq = as->q + (as->done & (as->qsz - 1));
+            if (tt_acked(tt) < rq->end) break;
+            as_done(as, (s32_t) rq->len);
+        }
+
+        if (as->done == t) {
+            if (TT_LOAD_SC(&as->stop)) break;
+
+            /* 队列为空，登记等待后再检查一次，之后放入的请求会写wfd唤醒 */
+            TT_STORE_SC(&as->idle, 1);
+            if (t == TT_LOAD_SC(&as->tail) && !TT_LOAD_SC(&as->stop)) {
+                rt = read(as->wfd, &v, sizeof(v));
+                (void) rt;
+            }
+            TT_STORE(&as->idle, 0);
+            continue;
+        }
+
+        /* 数据流已中断，之后的请求不再发送 */
+        if (as->err) {
+            as_done(as, TT_ERRSEND);
+            continue;
+        }
+
+        /* 新请求追加到之前未确认的数据之后，数据段用完时等之前的确认 */
+        for (; as->sub != t; ++as->sub) {
+            rq = as->q + (as->sub & (as->qsz - 1));
+            if (tt_submit(tt, rq->buf, rq->len) < 0) break;
+            rq->end = tt->stot;
+        }
+
+        tt_tick(tt, as_now(tt));
+
+        if (as_flush(as) < 0) {
+            as_fail(as, TT_ERRSEND);
+            continue;
+        }
+
+        /* 对方已关闭或连续超时：最早未完成的请求报告其已确认的字节数 */
+        if (tt_is_closed(tt) || tt->nsend >= as->msend) {
+            rq = as->q + (as->done & (as->qsz - 1));
+            as_fail(as, as->done != as->sub ? (s32_t) (tt_acked(tt) - (rq->end - rq->len)) : 0);
+            continue;
+        }
+
+        /* 等待ACK（读超时后由tt_tick判断重发） */
+        n = tt->rcb(tt->usr, as->io, (s16_t) tt->mtu);
+        if (n < 0) {
+            as_fail(as, TT_ERRRECV);
+            continue;
+        }
+        if (n > 0) tt_input(tt, as->io, (u32_t) n);
+    }
+
+    return 0;
+}
+
+s32_t tt_async_start(tt_async* as, tt_t* tt, u32_t depth, s32_t msend, tt_ascb cb)
+{
+    u32_t qsz = 1;
+
+    if (!depth) depth = TT_ASQDEP;
+    while (qsz < depth) qsz <<= 1;
+
+    as->tt = tt;
+    as->cb = cb;
+    as->msend = msend;
+    as->qsz = qsz;
+    as->tail = 0;
+    as->done = 0;
+    as->sub = 0;
+    as->head = 0;
+    as->stop = 0;
+    as->idle = 0;
+    as->err = 0;
+    as->tick = tt->tick;
+
+    as->q = malloc(qsz * sizeof(tt_asreq));
+    as->io = malloc(tt->mtu);
+    as->wfd = eventfd(0, 0);
+    as->efd = eventfd(0, EFD_NONBLOCK);
+
+    if (!as->q || !as->io || as->wfd < 0 || as->efd < 0) goto fail;
+
+    if (pthread_create(&as->th, 0, as_run, as)) goto fail;
+
+    return 0;
+
+fail:
+    if (as->wfd >= 0) close(as->wfd);
+    if (as->efd >= 0) close(as->efd);
+    free(as->q);
+    free(as->io);
+    as->q = 0;
+    as->io = 0;
+
+    return TT_ERRMEM;
+}
+
+void tt_async_stop(tt_async* as)
+{
+    TT_STORE_SC(&as->stop, 1);
+    fd_add(as->wfd);
+
+    pthread_join(as->th, 0);
+
+    /* 之后可能继续用阻塞接口，其定时不再由tt_tick推进 */
+    as->tt->tick = as->tick;
+
+    close(as->wfd);
+    close(as->efd);
+    free(as->q);
+    free(as->io);
+    as->q = 0;
+    as->io = 0;
+}
+
+s32_t tt_async_send(tt_async* as, const u8_t* buf, u32_t len, void* ctx)
+{
+    u32_t t = as->tail;
+    tt_asreq* rq;
+
+    if (TT_LOAD(&as->stop)) return TT_ERRFINAL;
+    if (TT_LOAD(&as->err)) return TT_ERRSEND;
+    if (t - TT_LOAD(&as->head) >= as->qsz) return TT_ERRBUSY;
+
+    rq = as->q + (t & (as->qsz - 1));
+    rq->buf = buf;
+    rq->len = len;
+    rq->ctx = ctx;
+
+    TT_STORE_SC(&as->tail, t + 1);
+
+    /* 引擎线程空闲时才需要唤醒，忙时不做系统调用 */
+    if (TT_LOAD_SC(&as->idle)) fd_add(as->wfd);
+
+    return 0;
+}
+
+s32_t tt_async_reap(tt_async* as, tt_asreq* rq)
+{
+    u32_t h = as->head;
+
+    if (as->cb || h == TT_LOAD(&as->done)) return 0;
+
+    *rq = as->q[h & (as->qsz - 1)];
+    TT_STORE(&as->head, h + 1);
+
+    return 1;
+}
+
+u32_t tt_async_pending(tt_async* as)
+{
+    return TT_LOAD(&as->tail) - TT_LOAD(&as->head);
+}
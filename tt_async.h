@@ -0,0 +1,81 @@
+#ifndef _TT_ASYNC_H_
+#define _TT_ASYNC_H_
+
+#include "tt.h"
+
+#include <pthread.h>
+
+/* 异步发送（仅Linux）：应用线程把待发送的数据块放入单生产者/单消费者的无锁环形队列后立即返回，
+ * 专用的引擎线程通过协议核心发送：队列中的请求依次以tt_submit追加（最多TT_NSEG个同时未确认），
+ * 窗口跨请求连续填充，不必等上一个请求确认完；包经wcb写出，ACK经rcb读入tt_input，定时由tt_tick推进
+ * （设置了tt_set_clock时使用该时钟，否则为CLOCK_MONOTONIC）。rcb须有读超时，重发定时的精度取决于它。
+ * 每个请求完成后在引擎线程中调用完成回调（如有），并使完成通知eventfd（tt_async.efd）计数加1，
+ * 应用线程可以通过epoll/poll等待。队列深度有上限，满时tt_async_send返回TT_ERRBUSY（背压）。
+ * 某个请求未能发完（连续超时重发msend次、对方关闭或读写出错）时数据流中断：之后的请求（包括之后放入的）
+ * 全部以TT_ERRSEND完成，tt_async_send也返回TT_ERRSEND。
+ * 引擎运行期间该连接只由引擎线程使用（同时收到的数据缓存在连接中），
+ * 其他线程不要调用该连接的tt_*函数，tt_async_stop之后可以继续用tt_recv等读取。
+ */
+
+#define TT_ASQDEP       64      /* 默认队列深度 */
+
+/* 完成回调（在引擎线程中调用），ctx/buf为提交时传入的参数，rt为已确认的字节数（小于len表示连续超时达到
+ * msend次或对方已关闭），小于0为错误码（TT_ERRSEND/TT_ERRRECV为写出/读取失败，之前的请求未发完时为TT_ERRSEND）。
+ */
+typedef void (*tt_ascb)(void* ctx, const u8_t* buf, s32_t rt);
+
+typedef struct {
+    const u8_t* buf;
+    u32_t       len;
+    void*       ctx;
+    s32_t       rt;     /* 完成后的结果（同完成回调的rt） */
+    u32_t       end;    /* 引擎内部：提交后在发送数据中的结束位置（tt_acked达到该值即完成） */
+} tt_asreq;
+
+typedef struct {
+    tt_t*       tt;
+    tt_ascb     cb;     /* 为空时由应用线程通过tt_async_reap取回结果 */
+    s32_t       msend;  /* 最大连续超时重发次数 */
+    tt_asreq*   q;      /* 请求环，qsz个 */
+    u32_t       qsz;    /* 队列深度（2的幂） */
+    int         wfd;    /* 唤醒引擎线程的eventfd */
+    int         efd;    /* 完成通知eventfd（非阻塞），计数为新完成的请求数 */
+    pthread_t   th;
+
+    /* 三个位置都自由增长，各由一个线程写入，分开放在不同的缓存行避免伪共享 */
+    u32_t       tail __attribute__((aligned(64)));     /* 应用线程已放入的位置 */
+    u8_t        stop;   /* 已请求停止，引擎线程发完队列中的请求后退出 */
+    u32_t       done __attribute__((aligned(64)));     /* 引擎线程已完成的位置 */
+    u32_t       sub;    /* 引擎线程已提交给协议核心的位置 */
+    u8_t        idle;   /* 引擎线程因队列为空在wfd上等待 */
+    u8_t        err;    /* 数据流已中断，之后的请求都失败 */
+    u8_t        tick;   /* 启动前连接是否由tt_tick驱动（停止时恢复） */
+    u8_t*       io;     /* 引擎线程的收发缓存（mtu字节） */
+    u32_t       head __attribute__((aligned(64)));     /* 已取走结果（空出槽位）的位置 */
+} tt_async;
+
+/* 启动引擎线程，tt为已初始化（设置好rcb/wcb）的连接，depth为队列深度（0为TT_ASQDEP，向上取2的幂），
+ * msend为连续超时重发（其间无有效包）多少次后放弃，cb为完成回调（可为空，此时须调用tt_async_reap取回结果才会空出槽位）。
+ * 返回0成功，TT_ERRMEM表示分配或创建线程失败。
+ */
+s32_t tt_async_start(tt_async* as, tt_t* tt, u32_t depth, s32_t msend, tt_ascb cb);
+
+/* 停止引擎线程：已放入队列的请求全部完成后线程退出，返回时已释放队列与eventfd
+ */
+void tt_async_stop(tt_async* as);
+
+/* 放入一个发送请求（不拷贝，完成前须保持有效），返回0成功，
+ * 队列已满时返回TT_ERRBUSY（可等待efd后重试），已停止时返回TT_ERRFINAL，数据流已中断时返回TT_ERRSEND。
+ * 只能由一个线程调用。
+ */
+s32_t tt_async_send(tt_async* as, const u8_t* buf, u32_t len, void* ctx);
+
+/* 取回最早完成的请求（未设置完成回调时），返回1表示取到，0表示没有新完成的请求
+ */
+s32_t tt_async_reap(tt_async* as, tt_asreq* rq);
+
+/* 队列中未空出的请求个数（待发送、发送中及未取回的）
+ */
+u32_t tt_async_pending(tt_async* as);
+
+#endif // _TT_ASYNC_H_
@@ -0,0 +1,43 @@
+#include "tt_cc.h"
+
+static void aimd_init(tt_t* tt)
+{
+    tt->cwnd = TT_CWNDINIT;
+    tt->ssth = tt->nwnd;
+    tt->cacc = 0;
+}
+
+static void aimd_ack(tt_t* tt, u32_t n, u32_t rtt)
+{
+    (void) rtt;
+
+    /* 窗口已不受限时不再增大，避免恢复后突发 */
+    if (tt->cwnd >= tt->nwnd) return;
+
+    /* 慢启动：每确认一个包窗口加1 */
+    if (tt->cwnd < tt->ssth) {
+        tt->cwnd += n;
+        return;
+    }
+
+    /* 拥塞避免：每确认一个窗口的包窗口加1 */
+    tt->cacc += n;
+    while (tt->cacc >= tt->cwnd) {
+        tt->cacc -= tt->cwnd;
+        ++tt->cwnd;
+    }
+}
+
+static void aimd_loss(tt_t* tt, u8_t timeout)
+{
+    tt->ssth = tt->cwnd / 2 > TT_CWNDMIN ? tt->cwnd / 2 : TT_CWNDMIN;
+    tt->cwnd = timeout ? 1 : tt->ssth;
+    tt->cacc = 0;
+}
+
+const tt_cc tt_cc_aimd = {
+    "aimd",
+    aimd_init,
+    aimd_ack,
+    aimd_loss,
+};
@@ -0,0 +1,17 @@
+#ifndef _TT_CC_H_
+#define _TT_CC_H_
+
+#include "tt.h"
+
+/* 拥塞控制算法（tt_set_cc），窗口以包为单位：
+ *   tt_cc_aimd     慢启动 + 拥塞避免（AIMD），丢包时窗口减半，超时时窗口降为1
+ * 新算法（如基于时延）实现tt_cc的三个回调即可，状态保存在tt->cwnd/ssth/cacc中，
+ * 可参考tt->srtt、tt->rttvar及ack回调的RTT采样。
+ */
+
+#define TT_CWNDINIT     4       /* 初始拥塞窗口 */
+#define TT_CWNDMIN      2       /* 丢包后慢启动阈值的下限 */
+
+extern const tt_cc tt_cc_aimd;
+
+#endif // _TT_CC_H_
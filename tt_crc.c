@@ -0,0 +1,291 @@
+#include "tt_crc.h"
+
+#define TT_CRC_POLY     0x1021
+
+/* 需要生成的表个数，嵌入式平台只选用查表实现时仅占用512B */
+#if TT_CRC_IMPL == TT_CRC_BIT || TT_CRC_IMPL == TT_CRC_TAB
+#define TT_CRC_NTAB     1
+#elif TT_CRC_IMPL == TT_CRC_SLICE4
+#define TT_CRC_NTAB     4
+#else
+#define TT_CRC_NTAB     8
+#endif
+
+#if TT_CRC_IMPL == TT_CRC_CLMUL || TT_CRC_IMPL == TT_CRC_AUTO
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TT_CRC_X86      1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO)
+#define TT_CRC_ARM      1
+#include <arm_neon.h>
+#endif
+#endif
+
+typedef u16_t (*crc_fn)(u16_t crc, const u8_t* data, u32_t len);
+
+/* tab[k][b]为字节b后跟k个0字节的CRC */
+static u16_t tab[TT_CRC_NTAB][256];
+static u8_t  inited;
+
+/* 无进位乘法折叠常量：x^192 mod P、x^128 mod P */
+static u16_t k192;
+static u16_t k128;
+
+static u16_t crc_lazy(u16_t crc, const u8_t* data, u32_t len);
+
+static crc_fn fn = crc_lazy;
+static s32_t  impl = -1;
+
+static u16_t xpow_mod(u32_t n)
+{
+    u32_t r = 1;
+
+    while (n--) {
+        r <<= 1;
+        if (r & 0x10000) {
+            r ^= 0x10000 | TT_CRC_POLY;
+        }
+    }
+
+    return (u16_t) r;
+}
+
+static void crc_init(void)
+{
+    u32_t i, j;
+    u16_t c;
+
+    if (inited) return;
+
+    for (i = 0; i < 256; ++i) {
+        c = i << 8;
+        for (j = 0; j < 8; ++j) {
+            c = (c & 0x8000) ? (c << 1) ^ TT_CRC_POLY : c << 1;
+        }
+        tab[0][i] = c;
+    }
+
+    /* 每张表相当于在上一张表的基础上再追加一个0字节 */
+    for (j = 1; j < TT_CRC_NTAB; ++j) {
+        for (i = 0; i < 256; ++i) {
+            c = tab[j - 1][i];
+            tab[j][i] = (c << 8) ^ tab[0][c >> 8];
+        }
+    }
+
+    k192 = xpow_mod(192);
+    k128 = xpow_mod(128);
+
+    inited = 1;
+}
+
+static u16_t crc_bit(u16_t crc, const u8_t* data, u32_t len)
+{
+    u32_t j;
+
+    while (len--) {
+        crc ^= *data++ << 8;
+        for (j = 0; j < 8; ++j) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ TT_CRC_POLY : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+static u16_t crc_tab(u16_t crc, const u8_t* data, u32_t len)
+{
+    while (len--) {
+        crc = (crc << 8) ^ tab[0][(crc >> 8) ^ *data++];
+    }
+
+    return crc;
+}
+
+#if TT_CRC_NTAB >= 4
+static u16_t crc_slice4(u16_t crc, const u8_t* data, u32_t len)
+{
+    while (len >= 4) {
+        crc = tab[3][data[0] ^ (crc >> 8)] ^ tab[2][data[1] ^ (crc & 0xff)]
+            ^ tab[1][data[2]] ^ tab[0][data[3]];
+        data += 4;
+        len -= 4;
+    }
+
+    return crc_tab(crc, data, len);
+}
+#endif
+
+#if TT_CRC_NTAB >= 8
+static u16_t crc_slice8(u16_t crc, const u8_t* data, u32_t len)
+{
+    while (len >= 8) {
+        crc = tab[7][data[0] ^ (crc >> 8)] ^ tab[6][data[1] ^ (crc & 0xff)]
+            ^ tab[5][data[2]] ^ tab[4][data[3]]
+            ^ tab[3][data[4]] ^ tab[2][data[5]]
+            ^ tab[1][data[6]] ^ tab[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+
+    return crc_tab(crc, data, len);
+}
+#endif
+
+/* 无进位乘法折叠：
+ * 将数据按16字节（大端）视为GF(2)多项式，累加值A每次折叠为 A.hi*(x^192 mod P) ^ A.lo*(x^128 mod P)，
+ * 再与下一块异或，结果与原数据模P同余。最后将A的16字节连同剩余尾部交给查表实现完成约简。
+ */
+#if TT_CRC_X86
+__attribute__((target("pclmul,ssse3")))
+static u16_t crc_clmul(u16_t crc, const u8_t* data, u32_t len)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i k;
+    __m128i a;
+    __m128i b;
+    u8_t t[16];
+
+    /* 数据太短时折叠无收益 */
+    if (len < 32) return crc_slice8(crc, data, len);
+
+    k = _mm_set_epi64x(k192, k128);
+    a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data), bswap);
+    a = _mm_xor_si128(a, _mm_set_epi64x((long long) ((unsigned long long) crc << 48), 0));
+    data += 16;
+    len -= 16;
+
+    while (len >= 16) {
+        b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data), bswap);
+        b = _mm_xor_si128(b, _mm_clmulepi64_si128(a, k, 0x11));
+        a = _mm_xor_si128(b, _mm_clmulepi64_si128(a, k, 0x00));
+        data += 16;
+        len -= 16;
+    }
+
+    _mm_storeu_si128((__m128i*) t, _mm_shuffle_epi8(a, bswap));
+    crc = crc_slice8(TT_CRC_INIT, t, 16);
+
+    return crc_slice8(crc, data, len);
+}
+
+static s32_t clmul_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+#elif TT_CRC_ARM
+static uint8x16_t bswap128(uint8x16_t v)
+{
+    v = vrev64q_u8(v);
+    return vextq_u8(v, v, 8);
+}
+
+static u16_t crc_clmul(u16_t crc, const u8_t* data, u32_t len)
+{
+    poly64x2_t a;
+    uint8x16_t b;
+    u8_t t[16];
+
+    if (len < 32) return crc_slice8(crc, data, len);
+
+    b = bswap128(vld1q_u8(data));
+    b = veorq_u8(b, vreinterpretq_u8_u64(vcombine_u64(vcreate_u64(0), vcreate_u64((unsigned long long) crc << 48))));
+    a = vreinterpretq_p64_u8(b);
+    data += 16;
+    len -= 16;
+
+    while (len >= 16) {
+        b = bswap128(vld1q_u8(data));
+        b = veorq_u8(b, vreinterpretq_u8_p128(vmull_p64(vgetq_lane_p64(a, 1), k192)));
+        b = veorq_u8(b, vreinterpretq_u8_p128(vmull_p64(vgetq_lane_p64(a, 0), k128)));
+        a = vreinterpretq_p64_u8(b);
+        data += 16;
+        len -= 16;
+    }
+
+    vst1q_u8(t, bswap128(vreinterpretq_u8_p64(a)));
+    crc = crc_slice8(TT_CRC_INIT, t, 16);
+
+    return crc_slice8(crc, data, len);
+}
+
+static s32_t clmul_supported(void)
+{
+    return 1;
+}
+#endif
+
+static crc_fn crc_lookup(s32_t i)
+{
+    switch (i) {
+    case TT_CRC_BIT:    return crc_bit;
+    case TT_CRC_TAB:    return crc_tab;
+#if TT_CRC_NTAB >= 4
+    case TT_CRC_SLICE4: return crc_slice4;
+#endif
+#if TT_CRC_NTAB >= 8
+    case TT_CRC_SLICE8: return crc_slice8;
+#endif
+#if TT_CRC_X86 || TT_CRC_ARM
+    case TT_CRC_CLMUL:  return clmul_supported() ? crc_clmul : 0;
+#endif
+    default:            return 0;
+    }
+}
+
+static u16_t crc_lazy(u16_t crc, const u8_t* data, u32_t len)
+{
+    if (tt_crc_select(TT_CRC_IMPL) < 0) {
+        tt_crc_select(TT_CRC_TAB);
+    }
+
+    return fn(crc, data, len);
+}
+
+u16_t tt_crc16(u16_t crc, const u8_t* data, u32_t len)
+{
+    return fn(crc, data, len);
+}
+
+s32_t tt_crc_select(s32_t i)
+{
+    crc_fn f;
+
+    crc_init();
+
+    /* 按CLMUL、slice-by-8、slice-by-4、查表的顺序选择可用的实现 */
+    if (i == TT_CRC_AUTO) {
+        for (i = TT_CRC_CLMUL; i > TT_CRC_TAB && !crc_lookup(i); --i) ;
+    }
+
+    f = crc_lookup(i);
+    if (!f) return -1;
+
+    fn = f;
+    impl = i;
+
+    return i;
+}
+
+s32_t tt_crc_impl(void)
+{
+    if (impl < 0) {
+        tt_crc16(TT_CRC_INIT, 0, 0);
+    }
+
+    return impl;
+}
+
+const char* tt_crc_name(s32_t i)
+{
+    switch (i) {
+    case TT_CRC_BIT:    return "bitwise";
+    case TT_CRC_TAB:    return "table";
+    case TT_CRC_SLICE4: return "slice-by-4";
+    case TT_CRC_SLICE8: return "slice-by-8";
+    case TT_CRC_CLMUL:  return "clmul";
+    case TT_CRC_AUTO:   return "auto";
+    default:            return "unknown";
+    }
+}
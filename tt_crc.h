@@ -0,0 +1,46 @@
+#ifndef _TT_CRC_H_
+#define _TT_CRC_H_
+
+#include "tt.h"
+
+/* CRC16-CCITT（多项式0x1021，初值0，高位在前，不反转）
+ * 可选实现：
+ *   TT_CRC_BIT     逐位计算，无表
+ *   TT_CRC_TAB     单字节查表（512B表）
+ *   TT_CRC_SLICE4  slice-by-4（2KB表）
+ *   TT_CRC_SLICE8  slice-by-8（4KB表）
+ *   TT_CRC_CLMUL   无进位乘法折叠（x86 PCLMULQDQ / ARMv8 PMULL）
+ *   TT_CRC_AUTO    运行时检测CPU，支持CLMUL则使用，否则使用slice-by-8
+ * 编译时通过TT_CRC_IMPL指定默认实现，运行时可通过tt_crc_select()切换。
+ */
+
+#define TT_CRC_BIT      0
+#define TT_CRC_TAB      1
+#define TT_CRC_SLICE4   2
+#define TT_CRC_SLICE8   3
+#define TT_CRC_CLMUL    4
+#define TT_CRC_AUTO     5
+
+#ifndef TT_CRC_IMPL
+#if TT_USE_STD_FUNC
+#define TT_CRC_IMPL     TT_CRC_AUTO
+#else
+#define TT_CRC_IMPL     TT_CRC_TAB
+#endif
+#endif
+
+#define TT_CRC_INIT     0x0000
+
+/* 计算CRC，crc为上一段数据的结果（首段传入TT_CRC_INIT），可分段连续计算 */
+u16_t tt_crc16(u16_t crc, const u8_t* data, u32_t len);
+
+/* 切换CRC实现，返回实际使用的实现（不支持时返回负数且保持原实现不变） */
+s32_t tt_crc_select(s32_t impl);
+
+/* 当前使用的实现 */
+s32_t tt_crc_impl(void);
+
+/* 实现名称，用于日志/测速 */
+const char* tt_crc_name(s32_t impl);
+
+#endif // _TT_CRC_H_
@@ -0,0 +1,345 @@
+#include "tt_fec.h"
+
+#define TT_GF_POLY      0x11d
+
+#if TT_GF_IMPL != TT_GF_TAB
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TT_GF_X86       1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define TT_GF_ARM       1
+#include <arm_neon.h>
+#endif
+#endif
+
+typedef void (*madd_fn)(u8_t* dst, const u8_t* src, u8_t c, u32_t len);
+
+/* exp表长度加倍，log相加时无需取模 */
+static u8_t gexp[512];
+static u8_t glog[256];
+static u8_t inited;
+
+static void madd_lazy(u8_t* dst, const u8_t* src, u8_t c, u32_t len);
+
+static madd_fn fn = madd_lazy;
+static s32_t   impl = -1;
+
+static void gf_init(void)
+{
+    u32_t i;
+    u32_t x = 1;
+
+    if (inited) return;
+
+    for (i = 0; i < 255; ++i) {
+        gexp[i] = gexp[i + 255] = (u8_t) x;
+        glog[x] = (u8_t) i;
+        x <<= 1;
+        if (x & 0x100) x ^= TT_GF_POLY;
+    }
+
+    inited = 1;
+}
+
+u8_t tt_gf_mul(u8_t a, u8_t b)
+{
+    gf_init();
+
+    return a && b ? gexp[glog[a] + glog[b]] : 0;
+}
+
+u8_t tt_gf_inv(u8_t a)
+{
+    gf_init();
+
+    return gexp[255 - glog[a]];
+}
+
+/* 逐字节乘加，用于短数据及各实现的尾部 */
+static void madd_byte(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    u32_t lc = glog[c];
+
+    while (len--) {
+        if (*src) *dst ^= gexp[lc + glog[*src]];
+        ++dst;
+        ++src;
+    }
+}
+
+static void madd_tab(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    u8_t t[256];
+    u32_t i;
+
+    /* 数据太短时生成乘法表无收益 */
+    if (len < 256) {
+        madd_byte(dst, src, c, len);
+        return;
+    }
+
+    t[0] = 0;
+    for (i = 1; i < 256; ++i) {
+        t[i] = gexp[glog[c] + glog[i]];
+    }
+
+    for (i = 0; i < len; ++i) {
+        dst[i] ^= t[src[i]];
+    }
+}
+
+#if TT_GF_X86 || TT_GF_ARM
+/* 半字节乘法表：c*x = lo[x & 0xf] ^ hi[x >> 4] */
+static void gf_nib(u8_t c, u8_t* lo, u8_t* hi)
+{
+    u32_t i;
+
+    lo[0] = hi[0] = 0;
+    for (i = 1; i < 16; ++i) {
+        lo[i] = gexp[glog[c] + glog[i]];
+        hi[i] = gexp[glog[c] + glog[i << 4]];
+    }
+}
+#endif
+
+#if TT_GF_X86
+__attribute__((target("ssse3")))
+static void madd_simd(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    const __m128i m = _mm_set1_epi8(0x0f);
+    __m128i tl;
+    __m128i th;
+    __m128i s;
+    __m128i d;
+    u8_t lo[16];
+    u8_t hi[16];
+
+    gf_nib(c, lo, hi);
+    tl = _mm_loadu_si128((const __m128i*) lo);
+    th = _mm_loadu_si128((const __m128i*) hi);
+
+    while (len >= 16) {
+        s = _mm_loadu_si128((const __m128i*) src);
+        d = _mm_loadu_si128((const __m128i*) dst);
+        d = _mm_xor_si128(d, _mm_shuffle_epi8(tl, _mm_and_si128(s, m)));
+        d = _mm_xor_si128(d, _mm_shuffle_epi8(th, _mm_and_si128(_mm_srli_epi64(s, 4), m)));
+        _mm_storeu_si128((__m128i*) dst, d);
+        dst += 16;
+        src += 16;
+        len -= 16;
+    }
+
+    madd_byte(dst, src, c, len);
+}
+
+__attribute__((target("avx2")))
+static void madd_avx2(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    const __m256i m = _mm256_set1_epi8(0x0f);
+    __m256i tl;
+    __m256i th;
+    __m256i s;
+    __m256i d;
+    u8_t lo[16];
+    u8_t hi[16];
+
+    gf_nib(c, lo, hi);
+    /* VPSHUFB按128位分别查表，两半放同一张表 */
+    tl = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) lo));
+    th = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) hi));
+
+    while (len >= 32) {
+        s = _mm256_loadu_si256((const __m256i*) src);
+        d = _mm256_loadu_si256((const __m256i*) dst);
+        d = _mm256_xor_si256(d, _mm256_shuffle_epi8(tl, _mm256_and_si256(s, m)));
+        d = _mm256_xor_si256(d, _mm256_shuffle_epi8(th, _mm256_and_si256(_mm256_srli_epi64(s, 4), m)));
+        _mm256_storeu_si256((__m256i*) dst, d);
+        dst += 32;
+        src += 32;
+        len -= 32;
+    }
+
+    /* 尾部交给SSE实现，先清除高128位避免AVX/SSE切换的惩罚 */
+    _mm256_zeroupper();
+    madd_simd(dst, src, c, len);
+}
+
+static s32_t simd_supported(s32_t i)
+{
+    __builtin_cpu_init();
+    return i == TT_GF_AVX2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+}
+#elif TT_GF_ARM
+static void madd_simd(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    const uint8x16_t m = vdupq_n_u8(0x0f);
+    uint8x16_t tl;
+    uint8x16_t th;
+    uint8x16_t s;
+    uint8x16_t d;
+    u8_t lo[16];
+    u8_t hi[16];
+
+    gf_nib(c, lo, hi);
+    tl = vld1q_u8(lo);
+    th = vld1q_u8(hi);
+
+    while (len >= 16) {
+        s = vld1q_u8(src);
+        d = vld1q_u8(dst);
+        d = veorq_u8(d, vqtbl1q_u8(tl, vandq_u8(s, m)));
+        d = veorq_u8(d, vqtbl1q_u8(th, vshrq_n_u8(s, 4)));
+        vst1q_u8(dst, d);
+        dst += 16;
+        src += 16;
+        len -= 16;
+    }
+
+    madd_byte(dst, src, c, len);
+}
+
+static s32_t simd_supported(s32_t i)
+{
+    return i == TT_GF_SIMD;
+}
+#endif
+
+static madd_fn madd_lookup(s32_t i)
+{
+    switch (i) {
+    case TT_GF_TAB:     return madd_tab;
+#if TT_GF_X86
+    case TT_GF_SIMD:    return simd_supported(i) ? madd_simd : 0;
+    case TT_GF_AVX2:    return simd_supported(i) ? madd_avx2 : 0;
+#elif TT_GF_ARM
+    case TT_GF_SIMD:    return madd_simd;
+#endif
+    default:            return 0;
+    }
+}
+
+static void madd_lazy(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    if (tt_gf_select(TT_GF_IMPL) < 0) {
+        tt_gf_select(TT_GF_TAB);
+    }
+
+    tt_gf_madd(dst, src, c, len);
+}
+
+void tt_gf_madd(u8_t* dst, const u8_t* src, u8_t c, u32_t len)
+{
+    u32_t i;
+
+    if (!c) return;
+
+    /* 系数为1（异或校验）时直接异或 */
+    if (c == 1) {
+        for (i = 0; i < len; ++i) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+
+    fn(dst, src, c, len);
+}
+
+u8_t tt_fec_coef(u32_t j, u32_t i)
+{
+    u8_t y = (u8_t) (TT_FECM + i);
+
+    /* Cauchy矩阵 1/(x_j + y_i)（x_j = j，y_i = TT_FECM + i）各列除以第0行，列缩放不影响任意子式非奇异 */
+    return j ? tt_gf_mul(y, tt_gf_inv((u8_t) j ^ y)) : 1;
+}
+
+s32_t tt_fec_inv(u8_t* a, u32_t n)
+{
+    u8_t b[TT_FECM * TT_FECM];
+    u8_t t;
+    u32_t r;
+    u32_t i;
+    u32_t k;
+
+    if (n > TT_FECM) return -1;
+
+    for (r = 0; r < n; ++r) {
+        for (i = 0; i < n; ++i) {
+            b[r * n + i] = r == i;
+        }
+    }
+
+    /* Gauss-Jordan消元，b同步变换为逆矩阵 */
+    for (k = 0; k < n; ++k) {
+        for (r = k; r < n && !a[r * n + k]; ++r) ;
+        if (r == n) return -1;
+
+        if (r != k) {
+            for (i = 0; i < n; ++i) {
+                t = a[r * n + i]; a[r * n + i] = a[k * n + i]; a[k * n + i] = t;
+                t = b[r * n + i]; b[r * n + i] = b[k * n + i]; b[k * n + i] = t;
+            }
+        }
+
+        t = tt_gf_inv(a[k * n + k]);
+        for (i = 0; i < n; ++i) {
+            a[k * n + i] = tt_gf_mul(a[k * n + i], t);
+            b[k * n + i] = tt_gf_mul(b[k * n + i], t);
+        }
+
+        for (r = 0; r < n; ++r) {
+            t = a[r * n + k];
+            if (r == k || !t) continue;
+
+            for (i = 0; i < n; ++i) {
+                a[r * n + i] ^= tt_gf_mul(a[k * n + i], t);
+                b[r * n + i] ^= tt_gf_mul(b[k * n + i], t);
+            }
+        }
+    }
+
+    for (i = 0; i < n * n; ++i) {
+        a[i] = b[i];
+    }
+
+    return 0;
+}
+
+s32_t tt_gf_select(s32_t i)
+{
+    madd_fn f;
+
+    gf_init();
+
+    /* 按AVX2、SIMD、查表的顺序选择可用的实现 */
+    if (i == TT_GF_AUTO) {
+        for (i = TT_GF_AVX2; i > TT_GF_TAB && !madd_lookup(i); --i) ;
+    }
+
+    f = madd_lookup(i);
+    if (!f) return -1;
+
+    fn = f;
+    impl = i;
+
+    return i;
+}
+
+s32_t tt_gf_impl(void)
+{
+    if (impl < 0) {
+        tt_gf_madd(0, 0, 2, 0);
+    }
+
+    return impl;
+}
+
+const char* tt_gf_name(s32_t i)
+{
+    switch (i) {
+    case TT_GF_TAB:     return "table";
+    case TT_GF_SIMD:    return "simd";
+    case TT_GF_AVX2:    return "avx2";
+    case TT_GF_AUTO:    return "auto";
+    default:            return "unknown";
+    }
+}
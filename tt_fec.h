@@ -0,0 +1,54 @@
+#ifndef _TT_FEC_H_
+#define _TT_FEC_H_
+
+#include "tt.h"
+
+/* 前向纠错（tt_set_fec）使用的GF(256)运算（本原多项式0x11d）。
+ * 校验矩阵为按列归一化的Cauchy矩阵：第0行全为1（即异或校验），任意k个数据/校验包可解出整组（k-of-n）。
+ * 区域乘加（dst ^= c * src）可选实现：
+ *   TT_GF_TAB      单字节查表（每次调用按系数生成256B乘法表）
+ *   TT_GF_SIMD     半字节查表（x86 SSSE3 PSHUFB / ARMv8 NEON TBL），每次16字节
+ *   TT_GF_AVX2     半字节查表（AVX2 VPSHUFB），每次32字节
+ *   TT_GF_AUTO     运行时检测CPU，按AVX2、SIMD、查表的顺序选择
+ * 编译时通过TT_GF_IMPL指定默认实现，运行时可通过tt_gf_select()切换。
+ */
+
+#define TT_GF_TAB       0
+#define TT_GF_SIMD      1
+#define TT_GF_AVX2      2
+#define TT_GF_AUTO      3
+
+#ifndef TT_GF_IMPL
+#if TT_USE_STD_FUNC
+#define TT_GF_IMPL      TT_GF_AUTO
+#else
+#define TT_GF_IMPL      TT_GF_TAB
+#endif
+#endif
+
+#define TT_FECK         32      /* 每组数据包个数上限 */
+#define TT_FECM         4       /* 每组校验包个数上限 */
+
+/* 单字节乘法与求逆（a不为0） */
+u8_t tt_gf_mul(u8_t a, u8_t b);
+u8_t tt_gf_inv(u8_t a);
+
+/* dst[0..len) ^= c * src[0..len) */
+void tt_gf_madd(u8_t* dst, const u8_t* src, u8_t c, u32_t len);
+
+/* 第j个校验包中第i个数据包的系数（j < TT_FECM，i < TT_FECK），j为0时为1 */
+u8_t tt_fec_coef(u32_t j, u32_t i);
+
+/* 原地求n阶方阵a（行优先）的逆，返回0成功，小于0表示奇异 */
+s32_t tt_fec_inv(u8_t* a, u32_t n);
+
+/* 切换区域乘加的实现，返回实际使用的实现（不支持时返回负数且保持原实现不变） */
+s32_t tt_gf_select(s32_t impl);
+
+/* 当前使用的实现 */
+s32_t tt_gf_impl(void);
+
+/* 实现名称，用于日志/测速 */
+const char* tt_gf_name(s32_t impl);
+
+#endif // _TT_FEC_H_
@@ -0,0 +1,164 @@
+#include "tt_lz.h"
+
+/* 按小端读取4字节（不要求对齐） */
+static u32_t rd32(const u8_t* p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (u32_t) p[3] << 24;
+}
+
+static u32_t lz_hash(u32_t v)
+{
+    return (v * 2654435761u) >> (32 - TT_LZ_HBITS);
+}
+
+/* 写出长度扩展字节（n为超出15的部分），空间不足时返回0 */
+static u8_t* put_len(u8_t* op, const u8_t* oend, u32_t n)
+{
+    for (; n >= 255; n -= 255) {
+        if (op >= oend) return 0;
+        *op++ = 255;
+    }
+
+    if (op >= oend) return 0;
+    *op++ = (u8_t) n;
+
+    return op;
+}
+
+/* 写出一个序列：lit开始的nl个字面量，之后是距离为off、长度为ml的匹配（ml为0时只有字面量），空间不足时返回0 */
+static u8_t* put_seq(u8_t* op, const u8_t* oend, const u8_t* lit, u32_t nl, u32_t off, u32_t ml)
+{
+    u8_t* tok;
+    u32_t i;
+
+    if (op >= oend) return 0;
+
+    tok = op++;
+    *tok = (u8_t) ((nl < 15 ? nl : 15) << 4);
+    if (nl >= 15 && !(op = put_len(op, oend, nl - 15))) return 0;
+
+    if ((u32_t) (oend - op) < nl) return 0;
+    for (i = 0; i < nl; ++i) {
+        *op++ = lit[i];
+    }
+
+    if (!ml) return op;
+
+    ml -= TT_LZ_MINM;
+    *tok |= ml < 15 ? ml : 15;
+
+    if (oend - op < 2) return 0;
+    *op++ = off & 0xff;
+    *op++ = off >> 8;
+
+    if (ml >= 15 && !(op = put_len(op, oend, ml - 15))) return 0;
+
+    return op;
+}
+
+u32_t tt_lz_compress(u16_t* tab, const u8_t* src, u32_t len, u8_t* dst, u32_t cap)
+{
+    const u8_t* oend = dst + cap;
+    u8_t* op = dst;
+    u32_t anchor = 0;
+    u32_t miss = 0;
+    u32_t i = 0;
+    u32_t c;
+    u32_t m;
+    u32_t v;
+    u32_t h;
+
+    if (len > 0xffff) return 0;
+
+    while (i + TT_LZ_MINM <= len) {
+        v = rd32(src + i);
+        h = lz_hash(v);
+        c = tab[h];
+        tab[h] = (u16_t) i;
+
+        /* 表项可能是之前的数据留下的，位置在当前之前且数据相同才是匹配 */
+        if (c >= i || rd32(src + c) != v) {
+            /* 连续查找失败时加大步长，不可压缩的数据尽快放弃 */
+            i += 1 + (miss++ >> 4);
+            continue;
+        }
+        miss = 0;
+
+        for (m = TT_LZ_MINM; i + m < len && src[c + m] == src[i + m]; ++m) ;
+
+        /* 向前扩展匹配（前面的字面量中可能还有相同的部分） */
+        while (i > anchor && c > 0 && src[i - 1] == src[c - 1]) {
+            --i;
+            --c;
+            ++m;
+        }
+
+        op = put_seq(op, oend, src + anchor, i - anchor, i - c, m);
+        if (!op) return 0;
+
+        i += m;
+        anchor = i;
+
+        /* 匹配内部的位置不逐个登记，只补登记结尾附近的一个 */
+        if (i + TT_LZ_MINM <= len) {
+            tab[lz_hash(rd32(src + i - 2))] = (u16_t) (i - 2);
+        }
+    }
+
+    op = put_seq(op, oend, src + anchor, len - anchor, 0, 0);
+
+    return op ? (u32_t) (op - dst) : 0;
+}
+
+/* 读取长度扩展字节累加到*n，数据不足时返回0 */
+static const u8_t* get_len(const u8_t* ip, const u8_t* iend, u32_t* n)
+{
+    do {
+        if (ip >= iend) return 0;
+        *n += *ip;
+    } while (*ip++ == 255);
+
+    return ip;
+}
+
+s32_t tt_lz_decompress(const u8_t* src, u32_t len, u8_t* dst, u32_t cap)
+{
+    const u8_t* ip = src;
+    const u8_t* iend = src + len;
+    u32_t op = 0;
+    u32_t off;
+    u32_t t;
+    u32_t n;
+
+    while (ip < iend) {
+        t = *ip++;
+
+        n = t >> 4;
+        if (n == 15 && !(ip = get_len(ip, iend, &n))) return -1;
+        if ((u32_t) (iend - ip) < n || cap - op < n) return -1;
+
+        for (; n > 0; --n) {
+            dst[op++] = *ip++;
+        }
+
+        /* 最后一个序列只有字面量 */
+        if (ip == iend) break;
+
+        if (iend - ip < 2) return -1;
+        off = ip[0] | ip[1] << 8;
+        ip += 2;
+        if (!off || off > op) return -1;
+
+        n = t & 15;
+        if (n == 15 && !(ip = get_len(ip, iend, &n))) return -1;
+        n += TT_LZ_MINM;
+        if (cap - op < n) return -1;
+
+        /* 逐字节拷贝，距离小于长度时重复前面的模式 */
+        for (; n > 0; --n, ++op) {
+            dst[op] = dst[op - off];
+        }
+    }
+
+    return (s32_t) op;
+}
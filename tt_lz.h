@@ -0,0 +1,36 @@
+#ifndef _TT_LZ_H_
+#define _TT_LZ_H_
+
+#include "tt.h"
+
+/* 负载压缩（tt_set_lz）使用的LZ77类编解码，每个包独立压缩，不依赖之前的包（丢包、重发不影响解码）。
+ * 压缩数据由若干序列组成，每个序列：
+ * ----------------------------------------------------------------------------
+ * | token | 字面量长度扩展 | 字面量 | 匹配距离 | 匹配长度扩展 |
+ * |  1B   |     0~nB       |  <n>   |  2B(LE)  |     0~nB     |
+ * ----------------------------------------------------------------------------
+ * token高4位为字面量长度，低4位为匹配长度 - TT_LZ_MINM，为15时后面跟扩展字节（逐个累加，直到不为255的字节）。
+ * 最后一个序列只有字面量（数据在字面量之后结束）。匹配距离为1~65535，允许与输出重叠（重复模式）。
+ */
+
+#define TT_LZ_MINM      4       /* 最短匹配长度 */
+
+#ifndef TT_LZ_HBITS
+#if TT_USE_STD_FUNC
+#define TT_LZ_HBITS     12      /* 匹配查找哈希表的位数（表为2^n个u16_t） */
+#else
+#define TT_LZ_HBITS     10
+#endif
+#endif
+
+#define TT_LZ_HSZ       (1u << TT_LZ_HBITS)
+
+/* 压缩src[0..len)（len不超过65535）到dst，输出超过cap字节（压缩无收益）时放弃并返回0，否则返回压缩后的长度。
+ * tab为TT_LZ_HSZ个单元的哈希表，由调用者提供，无需初始化（查到的位置都会比较数据）。
+ */
+u32_t tt_lz_compress(u16_t* tab, const u8_t* src, u32_t len, u8_t* dst, u32_t cap);
+
+/* 解压src[0..len)到dst，返回解压后的长度，数据错误或超过cap字节时返回小于0 */
+s32_t tt_lz_decompress(const u8_t* src, u32_t len, u8_t* dst, u32_t cap);
+
+#endif // _TT_LZ_H_
@@ -0,0 +1,257 @@
+#include "tt_mux.h"
+#include "tt_crc.h"
+
+#if TT_USE_STD_FUNC
+#include <stdio.h>
+#include <stdlib.h>
+
+#define tt_malloc   malloc
+#define tt_free     free
+
+#define tt_println(fmt, ...) \
+            printf("[%s:%d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+#else
+#define tt_malloc   TT_MALLOC
+#define tt_free     TT_FREE
+
+#define tt_println(fmt, ...)
+#endif
+
+/* 与tt_new.c中的包头布局一致：len在5、6字节，cid在7、8字节，之后可能还有接收窗口 */
+#define TT_MUX_LEN(p)       ((p)[5] << 8 | (p)[6])
+#define TT_MUX_CID(p)       ((p)[7] << 8 | (p)[8])
+#define TT_MUX_HSZ(p)       ((p)[0] & TT_FWND ? TT_SZHDRX : TT_SZHDR2)
+#define TT_MUX_CRC(p, h, l) ((p)[(h) - 2 + (l)] << 8 | (p)[(h) - 1 + (l)])
+
+/* 按通道设置的校验函数（tt_set_crc）计算CRC，cid未注册时使用tt_crc16 */
+static u16_t mux_crc(tt_mux* mx, u16_t cid, const u8_t* data, u32_t len)
+{
+    tt_t* tt = cid < mx->nch ? mx->ch[cid] : 0;
+
+    return tt && tt->crcf ? tt->crcf(TT_CRC_INIT, data, len) : tt_crc16(TT_CRC_INIT, data, len);
+}
+
+/* 解析缓存中从off开始的完整包，按cid分发，返回解析到的位置（其后不足一个包） */
+static u32_t mux_parse(tt_mux* mx)
+{
+    u32_t off = 0;
+    u32_t n;
+    u8_t* pkt;
+    u16_t hsz;
+    u16_t pl;
+    u16_t cid;
+
+    while ((n = mx->rlen - off) > 0) {
+        pkt = mx->rxb + off;
+
+        /* flag错误、负载过长、CRC校验失败时跳过一个字节，重新同步 */
+        if ((pkt[0] & TT_FMASK & ~(TT_FWND | TT_FFEC | TT_FLZ)) != (TT_FTAG2 & ~(TT_FFEC | TT_FLZ))) {
+            ++off;
+            continue;
+        }
+
+        hsz = TT_MUX_HSZ(pkt);
+        if (n < hsz) break;
+
+        pl = TT_MUX_LEN(pkt);
+        if (pl > mx->mtu - hsz) {
+            tt_println("mux got an error packet (payload)");
+            ++off;
+            continue;
+        }
+
+        if (n < hsz + pl) break;
+
+        cid = TT_MUX_CID(pkt);
+        if (TT_MUX_CRC(pkt, hsz, pl) != mux_crc(mx, cid, pkt, pl + hsz - 2)) {
+            tt_println("mux got an error packet (crc)");
+            ++off;
+            continue;
+        }
+
+        /* 整包交给对应通道（通道内会再次校验） */
+        if (cid < mx->nch && mx->ch[cid]) {
+            tt_input(mx->ch[cid], pkt, hsz + pl);
+        } else {
+            tt_println("mux drop packet of cid %d", cid);
+            ++mx->ndrop;
+        }
+
+        off += hsz + pl;
+    }
+
+    return off;
+}
+
+s32_t tt_mux_init(tt_mux* mx, u16_t nch, u16_t mtu)
+{
+    u8_t* mem;
+    u16_t i;
+
+    mx->ch = 0;
+    mx->rxb = 0;
+
+    if (nch < 1 || mtu <= TT_SZHDR2 || mtu > 0x7fff) {
+        tt_println("invalid mux nch %d mtu %d", nch, mtu);
+        return TT_ERRMEM;
+    }
+
+    /* 通道表与解析缓存一次分配 */
+    mem = tt_malloc(nch * sizeof(tt_t*) + 2u * mtu);
+    if (!mem) {
+        tt_println("malloc mux failed");
+        return TT_ERRMEM;
+    }
+
+    mx->ch = (tt_t**) mem;
+    mx->rxb = mem + nch * sizeof(tt_t*);
+    mx->nch = nch;
+    mx->cur = 0;
+    mx->mtu = mtu;
+    mx->rlen = 0;
+    mx->ndrop = 0;
+    mx->now = 0;
+    mx->rts = 0;
+    mx->stl = TT_MUXSTL;
+
+    for (i = 0; i < nch; ++i) {
+        mx->ch[i] = 0;
+    }
+
+    return 0;
+}
+
+void tt_mux_deinit(tt_mux* mx)
+{
+    if (mx->ch) {
+        tt_free(mx->ch);
+    }
+
+    mx->ch = 0;
+    mx->rxb = 0;
+    mx->nch = 0;
+    mx->rlen = 0;
+}
+
+s32_t tt_mux_add(tt_mux* mx, tt_t* tt, u16_t cid)
+{
+    if (cid >= mx->nch || mx->ch[cid] || tt->mtu != mx->mtu) {
+        tt_println("invalid mux channel %d", cid);
+        return TT_ERRMEM;
+    }
+
+    if (tt_set_cid(tt, cid) < 0) return TT_ERRMEM;
+
+    mx->ch[cid] = tt;
+
+    return 0;
+}
+
+void tt_mux_del(tt_mux* mx, u16_t cid)
+{
+    if (cid < mx->nch) {
+        mx->ch[cid] = 0;
+    }
+}
+
+/* 解析缓存中的包，未解析的部分（不足一个包）移到缓存开头，开头的包变化时重新计算等待时间 */
+static void mux_shift(tt_mux* mx, u8_t fresh)
+{
+    u32_t off = mux_parse(mx);
+    u32_t i;
+
+    for (i = off; i < mx->rlen; ++i) {
+        mx->rxb[i - off] = mx->rxb[i];
+    }
+    mx->rlen -= off;
+
+    if (off || fresh) mx->rts = mx->now;
+}
+
+s32_t tt_mux_input(tt_mux* mx, const u8_t* data, u32_t len)
+{
+    u32_t done = 0;
+    u32_t n;
+    u32_t i;
+    u8_t fresh;
+
+    while (done < len) {
+        n = 2u * mx->mtu - mx->rlen;
+        if (n > len - done) n = len - done;
+
+        fresh = !mx->rlen;
+        for (i = 0; i < n; ++i) {
+            mx->rxb[mx->rlen + i] = data[done + i];
+        }
+        mx->rlen += n;
+        done += n;
+
+        mux_shift(mx, fresh);
+    }
+
+    return done;
+}
+
+s32_t tt_mux_poll_output(tt_mux* mx, u8_t* buf, u32_t len)
+{
+    tt_t* tt;
+    s32_t n;
+    u16_t i;
+
+    /* 从上次之后的通道开始轮流取，每次一个包，避免某个通道独占传输 */
+    for (i = 0; i < mx->nch; ++i) {
+        tt = mx->ch[(mx->cur + i) % mx->nch];
+        if (!tt) continue;
+
+        n = tt_poll_output(tt, buf, len);
+        if (n != 0) {
+            mx->cur = (mx->cur + i + 1) % mx->nch;
+            return n;
+        }
+    }
+
+    return 0;
+}
+
+void tt_mux_tick(tt_mux* mx, u32_t now)
+{
+    u16_t i;
+
+    mx->now = now;
+
+    /* 不完整的包等待超过stl，多半是长度字段出错，跳过一个字节重新同步并解析其后已收到的包 */
+    if (mx->rlen && (s32_t) (now - mx->rts) >= (s32_t) mx->stl) {
+        tt_println("mux partial packet stalled, resync");
+        for (i = 1; i < mx->rlen; ++i) {
+            mx->rxb[i - 1] = mx->rxb[i];
+        }
+        --mx->rlen;
+        mux_shift(mx, 1);
+    }
+
+    for (i = 0; i < mx->nch; ++i) {
+        if (mx->ch[i]) tt_tick(mx->ch[i], now);
+    }
+}
+
+s32_t tt_mux_timeout(tt_mux* mx)
+{
+    s32_t t = -1;
+    s32_t d;
+    u16_t i;
+
+    for (i = 0; i < mx->nch; ++i) {
+        if (!mx->ch[i]) continue;
+
+        d = tt_timeout(mx->ch[i]);
+        if (d >= 0 && (t < 0 || d < t)) t = d;
+    }
+
+    if (mx->rlen) {
+        d = (s32_t) (mx->rts + mx->stl - mx->now);
+        if (d < 0) d = 0;
+        if (t < 0 || d < t) t = d;
+    }
+
+    return t;
+}
@@ -0,0 +1,62 @@
+#ifndef _TT_MUX_H_
+#define _TT_MUX_H_
+
+#include "tt.h"
+
+/* 多路复用：多个tt_t共用一个传输（串口、socket等），各通道使用带连接ID的版本2包头（tt_set_cid）。
+ * 收到的字节通过tt_mux_input输入，按cid整包分发给对应通道；待发送的包通过tt_mux_poll_output
+ * 在各通道间轮流取出，各通道有独立的窗口与定时，一个通道阻塞（未确认、未读取）不影响其他通道。
+ * 通道可以另外开启接收窗口通告（tt_set_rwnd），未读取的通道不会让对方持续重发。
+ * 通道也可以开启前向纠错（tt_set_fec）、负载压缩（tt_set_lz），校验包、压缩包同样按cid分发。
+ * 分发前按目标通道的校验函数（tt_set_crc）校验整包。
+ */
+
+#define TT_MUXSTL       TT_RTOINIT  /* 默认的不完整包停滞时间（毫秒） */
+
+typedef struct {
+    tt_t**  ch;     /* 各通道，下标为cid（未使用为0） */
+    u16_t   nch;    /* 通道数，cid取0~nch-1 */
+    u16_t   cur;    /* 下一个轮询输出的通道 */
+    u16_t   mtu;    /* 各通道的mtu（需一致） */
+    u8_t*   rxb;    /* 解析缓存，2*mtu字节 */
+    u32_t   rlen;   /* 解析缓存中的字节数 */
+    u32_t   ndrop;  /* cid未注册而丢弃的包个数 */
+    u32_t   now;    /* 当前时间（毫秒），由tt_mux_tick更新 */
+    u32_t   rts;    /* 解析缓存开头的不完整包开始等待的时间 */
+    u32_t   stl;    /* 不完整的包等待多久（毫秒）后视为停滞并重新同步（默认TT_MUXSTL，可在tt_mux_init后修改） */
+} tt_mux;
+
+/* 初始化，nch为通道数（cid上限），mtu为各通道的mtu。
+ * 通道表与解析缓存通过TT_MALLOC分配，返回0成功，TT_ERRMEM表示参数错误或分配失败。
+ */
+s32_t tt_mux_init(tt_mux* mx, u16_t nch, u16_t mtu);
+
+/* 释放tt_mux_init分配的缓存（不释放各通道）
+ */
+void tt_mux_deinit(tt_mux* mx);
+
+/* 注册通道（已tt_init，mtu与mx一致），并设置其连接ID为cid，返回0成功，TT_ERRMEM表示cid无效或已被占用
+ */
+s32_t tt_mux_add(tt_mux* mx, tt_t* tt, u16_t cid);
+
+/* 注销通道，之后收到该cid的包被丢弃
+ */
+void tt_mux_del(tt_mux* mx, u16_t cid);
+
+/* 输入从共用传输收到的字节（可按任意长度分段），返回接受的字节数
+ */
+s32_t tt_mux_input(tt_mux* mx, const u8_t* data, u32_t len);
+
+/* 从下一个有待发送包的通道取出一个包写入buf（len不小于mtu），返回包长，0表示各通道都没有待发送的包
+ */
+s32_t tt_mux_poll_output(tt_mux* mx, u8_t* buf, u32_t len);
+
+/* 推进所有通道的定时器，见tt_tick
+ */
+void tt_mux_tick(tt_mux* mx, u32_t now);
+
+/* 所有通道中最近的定时器到期毫秒数，见tt_timeout
+ */
+s32_t tt_mux_timeout(tt_mux* mx);
+
+#endif // _TT_MUX_H_
@@ -1,13 +1,21 @@
 
 #include "tt.h"
+#include "tt_crc.h"
+#include "tt_cc.h"
+#include "tt_fec.h"
+#include "tt_lz.h"
+#include "tt_pool.h"
 
 #if TT_USE_STD_FUNC
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 
 #define tt_memcpy   memcpy
 #define tt_memmove  memmove
 #define tt_memset   memset
+#define tt_malloc   malloc
+#define tt_free     free
 
 #define tt_println(fmt, ...) \
             printf("[%s:%d] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__)
@@ -15,29 +23,82 @@
 #define tt_memcpy   _tt_memcpy
 #define tt_memmove  _tt_memcpy
 #define tt_memset   _tt_memset
+#define tt_malloc   TT_MALLOC   /* 需由平台定义，如rt_malloc */
+#define tt_free     TT_FREE     /* 需由平台定义，如rt_free */
 
 #define tt_println(fmt, ...)
 #endif
 
-#define TT_FMASK    0b11111100
-#define TT_FTAG     0b11001100
-
 #define TT_ACK      0b01
 #define TT_FIN      0b10
+#define TT_PRB      (TT_FIN | TT_ACK)   /* 探测包 */
+
+/* 待发送的控制包（tt->pend） */
+#define TT_PACK     0x01    /* ACK */
+#define TT_PFIN     0x02    /* FIN（回复对方或主动关闭） */
+#define TT_PWND     0x04    /* 窗口探测 */
+#define TT_PCAP     0x08    /* 能力通告 */
 
 #define TT_SET_FLG(p, x)    p[0] = (x)
 #define TT_SET_SEQ(p, x)    p[1] = (x) >> 8, p[2] = (x) & 0xff
 #define TT_SET_ACK(p, x)    p[3] = (x) >> 8, p[4] = (x) & 0xff
 #define TT_SET_LEN(p, x)    p[5] = (x) >> 8, p[6] = (x) & 0xff
-#define TT_SET_CRC(p, l, x) p[7 + (l)] = (x) >> 8, p[8 + (l)] = (x) & 0xff
-#define TT_SET_PLD(p, l, x) tt_memcpy(&p[7], x, l)
+#define TT_SET_CID(p, x)    p[7] = (x) >> 8, p[8] = (x) & 0xff
+
+/* 负载与CRC的位置取决于包头版本（tt->hsz） */
+#define TT_SET_CRC(tt, p, l, x) p[(tt)->hsz - 2 + (l)] = (x) >> 8, p[(tt)->hsz - 1 + (l)] = (x) & 0xff
+#define TT_SET_PLD(tt, p, l, x) tt_memcpy(&p[(tt)->hsz - 2], x, l)
 
 #define TT_GET_FLG(p)       (p[0])
 #define TT_GET_SEQ(p)       (p[1] << 8 | p[2])
 #define TT_GET_ACK(p)       (p[3] << 8 | p[4])
 #define TT_GET_LEN(p)       (p[5] << 8 | p[6])
-#define TT_GET_CRC(p, l)    (p[7 + (l)] << 8 | p[8 + (l)])
-#define TT_GET_PLD(p)       (&p[7])
+#define TT_GET_CID(p)       (p[7] << 8 | p[8])
+
+/* 接收窗口字段在连接ID（如有）之后 */
+#define TT_WOFF(tt)             ((tt)->ftag & TT_FCID ? 9 : 7)
+#define TT_SET_WND(tt, p, x)    p[TT_WOFF(tt)] = (x) >> 8, p[TT_WOFF(tt) + 1] = (x) & 0xff
+#define TT_GET_WND(tt, p)       (p[TT_WOFF(tt)] << 8 | p[TT_WOFF(tt) + 1])
+
+#define TT_GET_CRC(tt, p, l)    (p[(tt)->hsz - 2 + (l)] << 8 | p[(tt)->hsz - 1 + (l)])
+#define TT_GET_PLD(tt, p)       (&p[(tt)->hsz - 2])
+
+/* 线上序号只有16位，内部使用32位扩展序号，比较时按序号差（有符号）判断先后 */
+#define TT_SEQ_DIFF(a, b)   ((s32_t) ((u32_t) (a) - (u32_t) (b)))
+
+/* 多字位图 */
+#define TT_NWORD(n)         (((n) + 31) >> 5)
+#define TT_BGET(m, i)       ((m)[(i) >> 5] >> ((i) & 31) & 1)
+#define TT_BSET(m, i)       ((m)[(i) >> 5] |= 1u << ((i) & 31))
+#define TT_BCLR(m, i)       ((m)[(i) >> 5] &= ~(1u << ((i) & 31)))
+
+/* 窗口为环形，下标b向后偏移i个单元 */
+#define TT_RING(tt, b, i)   (((b) + (i)) % (tt)->nwnd)
+/* 接收缓存第i个单元（使用缓存池时为借到的单元） */
+#define TT_BUF(tt, i)       ((tt)->bptr ? (tt)->bptr[i] : (tt)->buf + (u32_t) (i) * TT_MPL(tt))
+/* 单包最大负载长度 */
+#define TT_MPL(tt)          ((tt)->mtu - (tt)->hsz)
+/* 数据包负载上限，开启FEC时为校验包中的长度编码预留2字节 */
+#define TT_DPL(tt)          (TT_MPL(tt) - ((tt)->fk ? 2 : 0))
+/* 有效窗口：拥塞窗口与窗口大小的较小值 */
+#define TT_CWND(tt)         ((tt)->cc && (tt)->cwnd < (tt)->nwnd ? (tt)->cwnd : (tt)->nwnd)
+/* 窗口探测间隔：RTO按连续探测次数指数退避，不超过TT_RTOMAX */
+#define TT_WIVL(tt)         ((tt)->rto << (tt)->wnum < TT_RTOMAX ? (tt)->rto << (tt)->wnum : TT_RTOMAX)
+/* 对方接收窗口是否还能容纳下一个新包（未开启窗口通告时总是可以） */
+#define TT_WOPEN(tt)        (!((tt)->ftag & TT_FWND) || TT_SEQ_DIFF((tt)->rwr, (tt)->seq + (tt)->nsnt) > 0)
+/* 是否按时间（tt->now）判断超时：设置了时钟或由tt_tick驱动 */
+#define TT_TIMED(tt)        ((tt)->clk || (tt)->tick)
+
+/* flag（版本与保留位）是否为本端接收的包：普通包、压缩数据包，以及开启FEC时的校验包 */
+#define TT_FOK(tt, f)       (((f) & TT_FMASK) == (tt)->ftag || ((f) & TT_FMASK) == ((tt)->ftag ^ TT_FLZ) \
+                             || ((tt)->fk && ((f) & TT_FMASK) == ((tt)->ftag ^ TT_FFEC)))
+/* 压缩连续无收益的退避次数上限（之后每次跳过2^n - 1个包） */
+#define TT_ZMISS            6
+/* 收到未压缩的数据包时最多发送几次能力通告（对方开始压缩后不再发送） */
+#define TT_ZANN             4
+
+/* FEC校验行长度（2字节负载长度的编码 + 负载的编码），不超过校验包的最大负载 */
+#define TT_FSZ(tt)          ((tt)->mtu - TT_SZHDR)
 
 
 #if !TT_USE_STD_FUNC
@@ -55,759 +116,2236 @@ static void _tt_memset(u8_t* dst, u8_t val, u32_t len)
 }
 #endif
 
-static u16_t crc16(const u8_t* data, u32_t len)
+/* 帧校验默认走tt_crc16（具体实现见tt_crc.c），连接可以通过tt_set_crc指定其他实现；crc为上一段的结果 */
+static u16_t crc16_next(tt_t* tt, u16_t crc, const u8_t* data, u32_t len)
 {
-    u16_t crc = 0;
+    return tt->crcf ? tt->crcf(crc, data, len) : tt_crc16(crc, data, len);
+}
 
-#if 1
-    while (len--) {
-        crc = crc >> 1 | crc << 15;
-        crc += *data++;
-    }
-#else
-    u32_t i, j;
-    u16_t t;
+static u16_t crc16(tt_t* tt, const u8_t* data, u32_t len)
+{
+    return crc16_next(tt, TT_CRC_INIT, data, len);
+}
 
-    for (i = 0; i < len; i++) {
-        for (j = 0; j < 8; j++) {
-            t = ((data[i] << j) & 0x80) ^ ((crc & 0x8000) >> 8);
-            crc <<= 1;
+/* 将16位线上序号扩展为与ref最接近的32位序号（窗口远小于32768，不会有歧义） */
+static u32_t seq_ext(u32_t ref, u16_t s)
+{
+    return ref + (s16_t) (u16_t) (s - (u16_t) ref);
+}
 
-            if(t != 0) {
-                crc ^= 0x1021;
-            }
-        }
+/* 用一次RTT采样更新SRTT/RTTVAR并重新计算RTO（RFC 6298） */
+static void rtt_sample(tt_t* tt, u32_t rtt)
+{
+    s32_t d;
+
+    if (!tt->srtt && !tt->rttvar) {
+        tt->srtt = rtt << 3;
+        tt->rttvar = rtt << 1;
+    } else {
+        d = (s32_t) rtt - (s32_t) (tt->srtt >> 3);
+        if (d < 0) d = -d;
+
+        tt->rttvar += d - (tt->rttvar >> 2);
+        tt->srtt += rtt - (tt->srtt >> 3);
     }
-#endif
 
-    return crc;
+    tt->rto = (tt->srtt >> 3) + (tt->rttvar > 1 ? tt->rttvar : 1);
+
+    if (tt->rto < TT_RTOMIN) tt->rto = TT_RTOMIN;
+    if (tt->rto > TT_RTOMAX) tt->rto = TT_RTOMAX;
 }
 
-void tt_init(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t mackr, void* usr)
+/* 重传超时后RTO指数退避，收到新的RTT采样后恢复 */
+static void rto_backoff(tt_t* tt)
 {
-    tt_memset(tt, 0, sizeof(tt_t));
+    tt->rto = tt->rto > TT_RTOMAX / 2 ? TT_RTOMAX : tt->rto << 1;
+}
 
-    tt->rcb = rcb;
-    tt->wcb = wcb;
-    tt->mackr = mackr;
-    tt->usr = usr;
+/* 未退避的RTO（SRTT + 4*RTTVAR，未测得RTT时为TT_RTOINIT），用于判断输入是否停滞 */
+static u32_t rto_base(tt_t* tt)
+{
+    u32_t rto;
+
+    if (!tt->srtt && !tt->rttvar) return TT_RTOINIT;
+
+    rto = (tt->srtt >> 3) + (tt->rttvar > 1 ? tt->rttvar : 1);
+    return rto < TT_RTOMIN ? TT_RTOMIN : rto > TT_RTOMAX ? TT_RTOMAX : rto;
 }
 
-void tt_reset(tt_t* tt)
+/* 使接收环中从off开始的len字节在内存中连续：跨越环尾的部分从环首拷贝到环尾之后的预留区 */
+static void frame_linear(tt_t* tt, u32_t off, u32_t len)
 {
-    tt->seq = 0;
-    tt->ack = 0;
-    tt->wnd = 0;
-    tt->closed = 0;
+    if (off + len > tt->rsz) {
+        tt_memcpy(tt->rxb + tt->rsz, tt->rxb, off + len - tt->rsz);
+    }
+}
 
-    tt_memset((void*) tt->blen, 0, sizeof(tt->blen));
+/* 丢弃当前位置的字节，向后查找下一个flag正确的字节作为可能的包头 */
+static void frame_skip(tt_t* tt)
+{
+    do {
+        ++tt->rhd;
+    }
+    while (tt->rhd != tt->rtl && !TT_FOK(tt, tt->rxb[tt->rhd & (tt->rsz - 1)]));
 }
 
-s32_t tt_send(tt_t* tt, const u8_t* buf, s32_t len, s32_t msend)
+/* 当前位置的包不完整，记录开始等待的时间（同一位置继续等待时保持不变） */
+static void frame_wait(tt_t* tt)
 {
-    u8_t tmp[TT_SZPKT];
-    u8_t* pkt;
+    if (!tt->rwait || tt->rwp != tt->rhd) {
+        tt->rwait = 1;
+        tt->rwp = tt->rhd;
+        tt->rts = tt->now;
+    }
+}
+
+/* 输入停顿时接收环中还有不完整的包（读超时，或tt_tick发现同一位置等待超过一个RTO），多半是长度字段出错
+ * （对方不会再发来这么多数据），丢弃当前位置并重新同步，其后已收到的包由调用者继续解析
+ */
+static void frame_stall(tt_t* tt)
+{
+    tt_println("partial packet stalled, resync");
+    tt->rwait = 0;
+    frame_skip(tt);
+}
+
+/* 从rcb读取数据到接收环的空闲区（单次不跨越环尾），返回读取的字节数（0表示超时），小于0表示出错。
+ * 接收环已满时不读取，返回环中的字节数，由调用者继续解析。超时时丢弃不完整的包并重新同步。
+ */
+static s32_t frame_read(tt_t* tt)
+{
+    u32_t off = tt->rtl & (tt->rsz - 1);
+    u32_t n = tt->rsz - (tt->rtl - tt->rhd);
     s32_t rt;
-    s32_t sz;
-    s32_t rmn = len;/* 剩余字节 */
-    u32_t msk = 0;  /* mask每一位标识对应序号的包是否已收到ACK */
-    u32_t i;
-    u16_t pl;
-    u16_t crc;
-    s32_t nrecv;     /* 当前重收次数 */
-    s32_t nsend = 0; /* 当前重发次数 */
 
-    tt_println("tt_send len %d", len);
+    if (!n) return tt->rsz;
 
-    if (tt->closed) {
-        tt_println("connection is closed");
-        return TT_ERRFINAL;
+    if (n > tt->rsz - off) n = tt->rsz - off;
+    if (n > 0x7fff) n = 0x7fff;
+
+    rt = tt->rcb(tt->usr, tt->rxb + off, (s16_t) n);
+    if (rt > 0) tt->rtl += rt;
+
+    /* 读超时即输入停顿 */
+    if (!rt && tt->rtl != tt->rhd) {
+        frame_stall(tt);
     }
 
-    while (rmn > 0) {
-        sz = rmn;
-        rt = 0;
+    return rt;
+}
+
+/* 从接收环中取出下一个通过校验的包，返回包首地址（下次读取前有效），没有完整的包时返回0。
+ * 校验失败时只跳过当前位置并重新同步到下一个可能的包头，其后正确的包不受影响。
+ */
+static u8_t* frame_next(tt_t* tt)
+{
+    u32_t n;
+    u32_t off;
+    u8_t* pkt;
+    u16_t pl;
+    u16_t crc;
 
-        /* 发送一组数据 */
-        for (i = 0; i < TT_SZWND && sz > 0; ++i, sz -= rt) {
+    while ((n = tt->rtl - tt->rhd) > 0) {
+        off = tt->rhd & (tt->rsz - 1);
+        pkt = tt->rxb + off;
 
-            if ((1 << i) & msk) continue; /* 该包已收到ACK，无需再次发送 */
+        /* 收到了错误的包（flag错误），重新同步 */
+        if (!TT_FOK(tt, TT_GET_FLG(pkt))) {
+            tt_println("got an error packet (flag)");
+            frame_skip(tt);
+            continue;
+        }
 
-            rt = sz > TT_SZPL ? TT_SZPL : sz;
+        /* 接收长度不足一个包 */
+        if (n < tt->hsz) {
+            tt_println("packet need more (header)");
+            frame_wait(tt);
+            return 0;
+        }
 
-            tt_println("send packet %d, pl %d", tt->seq + i, rt);
+        frame_linear(tt, off, tt->hsz);
 
-            TT_SET_FLG(tmp, TT_FTAG);
-            TT_SET_SEQ(tmp, tt->seq + i);
-            TT_SET_ACK(tmp, tt->ack);
+        pl = TT_GET_LEN(pkt);
+        /* 收到了错误的包（负载过长），重新同步 */
+        if (pl > TT_MPL(tt)) {
+            tt_println("got an error packet (payload)");
+            frame_skip(tt);
+            continue;
+        }
 
-            TT_SET_LEN(tmp, rt);
-            TT_SET_PLD(tmp, rt, buf + (i * TT_SZPL));
+        /* 该包还未收完，保留 */
+        if (n < tt->hsz + pl) {
+            tt_println("packet need more (payload)");
+            frame_wait(tt);
+            return 0;
+        }
 
-            crc = crc16(tmp, rt + TT_SZHDR - 2);
-            TT_SET_CRC(tmp, rt, crc);
+        frame_linear(tt, off, tt->hsz + pl);
 
-            if (tt->wcb(tt->usr, tmp, TT_SZHDR + rt) < 0) {
-                tt_println("writecb (data) failed, return");
-                return TT_ERRSEND; // TODO
-            }
+        crc = crc16(tt, pkt, pl + tt->hsz - 2);
+        /* CRC校验失败，重新同步 */
+        if (TT_GET_CRC(tt, pkt, pl) != crc) {
+            tt_println("got an error packet (crc)");
+            frame_skip(tt);
+            continue;
         }
-        /* 此时i值标识该组数据中包个数 */
 
-        nsend = nsend + 1;
-        nrecv = 0;
-        sz = 0;
-        /* 接收ACK */
-        while (1) {
-            rt = tt->rcb(tt->usr, tmp + sz, TT_SZPKT - sz);
-            if (rt < 0) {
-                tt_println("readcb (ACK) failed");
-                return TT_ERRRECV;
-            }
+        tt->rhd += tt->hsz + pl;
 
-            if (!rt) {
-                if (++nrecv >= tt->mackr) {
-                    /* 连续接收超时次数达到tt->mackr，准备重发数据包 */
-                    tt_println("readcb (ACK) timeout count reach max, resend");
-                    break;
-                }
-                tt_println("readcb (ACK) timeout");
-                continue;
-            }
+        /* 其他连接的包（完整且校验正确），整包丢弃 */
+        if ((tt->ftag & TT_FCID) && TT_GET_CID(pkt) != tt->cid) {
+            tt_println("drop packet of cid %d", TT_GET_CID(pkt));
+            continue;
+        }
 
-            /* 先校验第一个字节是否正确，下面再进一步校验 */
-            if ((TT_GET_FLG(tmp) & TT_FMASK) != TT_FTAG) {
-                tt_println("got an error packet (flag) first");
-                continue;
-            }
+        return pkt;
+    }
 
-            sz += rt;
-            /* 接收长度不足一个包 */
-            if (sz < TT_SZHDR) {
-                tt_println("packet need more (header)");
-                continue;
-            }
+    tt->rwait = 0;
 
-            pkt = tmp;
-            /* 处理包（可能有多个） */
-            do {
-                /* 收到了错误的包（flag错误），丢弃 */
-                if ((TT_GET_FLG(pkt) & TT_FMASK) != TT_FTAG) {
-                    tt_println("got an error packet (flag)");
-                    sz = 0; break;
-                }
+    return 0;
+}
 
-                pl = TT_GET_LEN(pkt);
-                /* 收到了错误的包（负载过长），丢弃 */
-                if (pl > TT_SZPL) {
-                    tt_println("got an error packet (payload)");
-                    sz = 0; break;
-                }
+/* 将排队的数据包一次写出 */
+static s32_t frame_flush(tt_t* tt)
+{
+    u16_t n = tt->nbq;
 
-                /* 该包还未收完，保留 */
-                if (sz < TT_SZHDR + pl) {
-                    tt_println("packet need more (payload)");
-                    break;
-                }
+    if (!n) return 0;
 
-                crc = crc16(pkt, pl + TT_SZHDR - 2);
-                /* CRC校验失败，丢弃 */
-                if (TT_GET_CRC(pkt, pl) != crc) {
-                    tt_println("got an error packet (crc)");
-                    sz = 0; break;
-                }
+    tt->nbq = 0;
+    return tt->iocb(tt->usr, tt->biov, 3 * n);
+}
 
-                if ((TT_GET_FLG(pkt) & TT_ACK)) {
-                    /* 该包是ACK包 */
-                    rt = TT_GET_ACK(pkt);
-
-                    if (rt >= tt->seq && rt < tt->seq + i) {
-                        /* 将mask的第 rt - tt->seq 位置1 */
-                        msk |= 1 << (rt - tt->seq);
-                        tt_println("ACK %d recved", rt);
-                    } else {
-                        tt_println("ACK %d recved (out of range)", rt);
-                    }
-
-                } else if (TT_GET_FLG(pkt) & TT_FIN) {
-                    /* 该包是FIN包，表示TT_GET_ACK(pkt)之前的包已全部收到 */
-                    rt = TT_GET_ACK(pkt);
-
-                    if (rt > tt->seq && rt <= tt->seq + i) {
-                        /* 将mask的前 rt - tt->seq + 1 位全部置1 */
-                        msk |= (1 << (rt - tt->seq)) - 1;
-                        tt_println("FIN %d recved", rt);
-                    } else {
-                        tt_println("FIN %d recved (out of range)", rt);
-                    }
-
-                    /* 构造并返回FIN包 */
-                    TT_SET_SEQ(pkt, tt->seq);
-                    TT_SET_ACK(pkt, tt->ack);
-                    TT_SET_LEN(pkt, 0);
-
-                    crc = crc16(pkt, TT_SZHDR - 2);
-                    TT_SET_CRC(pkt, 0, crc);
-
-                    tt_println("send FIN");
-
-                    if (tt->wcb(tt->usr, pkt, TT_SZHDR) < 0) {
-                        tt_println("writecb (FIN) failed");
-                        // TODO
-                    }
-
-                    tt->closed = 1;
-
-                } else {
-                    rt = TT_GET_SEQ(pkt);
-
-                    /* 该包是数据包，如果之前已确定接收过则返回ACK，否则丢弃 */
-                    if (rt < tt->ack) {
-                        tt_println("data packet %d recved (duplicate), pl %d, reply ACK", rt, pl);
-
-                        /* 构造ACK包 */
-                        TT_SET_FLG(pkt, TT_FTAG | TT_ACK);
-                        TT_SET_SEQ(pkt, tt->seq);
-                        TT_SET_ACK(pkt, rt);
-                        TT_SET_LEN(pkt, 0);
-
-                        crc = crc16(pkt, TT_SZHDR - 2);
-                        TT_SET_CRC(pkt, 0, crc);
-
-                        /* 发送ACK */
-                        if (tt->wcb(tt->usr, pkt, TT_SZHDR) < 0) {
-                            tt_println("writecb (ACK) failed");
-                            // TODO
-                        }
-
-                    } else {
-                        tt_println("data packet %d recved (unaccepted), pl %d", rt, pl);
-                    }
-                }
+/* 发送一帧，设置了分散写回调时优先使用。已有排队的数据包时先写出，保证包的顺序 */
+static s32_t frame_write(tt_t* tt, u8_t* pkt, u16_t len)
+{
+    tt_iov iov;
+    s32_t rt;
+    u16_t n;
 
-                /* 重试次数清零 */
-                // nrecv = 0;
-                nsend = 0;
+    if (tt->iocb) {
+        if (frame_flush(tt) < 0) return -1;
 
-                pkt += TT_SZHDR + pl;
-                sz -= TT_SZHDR + pl;
-            }
-            while (sz > 0);
+        iov.buf = pkt;
+        iov.len = len;
+        return tt->iocb(tt->usr, &iov, 1);
+    }
 
-            if (msk == (1 << i) - 1) {
-                /* 已接收到该组数据的所有ACK */
-                tt_println("all ACK recved");
-                break;
-            }
+    /* 流式传输部分写出时继续写剩余部分 */
+    for (n = 0; n < len; n += rt) {
+        rt = tt->wcb(tt->usr, pkt + n, len - n);
+        if (rt <= 0) return rt;
+    }
 
-            if (sz > 0 && pkt != tmp) {
-                tt_println("recv buf left");
-                tt_memmove(tmp, pkt, sz);
-            }
-        }
+    return len;
+}
 
-        if (nsend >= msend) {
-            tt_println("resend count reach max, break");
-            break;
-        }
+/* 填写包头（flag、seq、ack、len及可选字段） */
+static void hdr_build(tt_t* tt, u8_t* out, u8_t flg, u32_t seq, u32_t ack, u16_t pl)
+{
+    TT_SET_FLG(out, tt->ftag | flg);
+    TT_SET_SEQ(out, seq);
+    TT_SET_ACK(out, ack);
+    TT_SET_LEN(out, pl);
 
-        for (i = 0; (1 << i) & msk; ++i) ;
+    if (tt->ftag & TT_FCID) {
+        TT_SET_CID(out, tt->cid);
+    }
 
-        /* 此时i为收到连续ACK的个数 */
-        if (i > 0) {
-            tt_println("send window >> %d", i);
+    /* 通告累计确认之后还能接收的包个数。
+     * 右边沿空出不足半个窗口时保持原通告不动，避免每读走一个包就放进一个包（糊涂窗口）。
+     */
+    if (tt->ftag & TT_FWND) {
+        u32_t cum = tt->ack + tt->nrun;
+        u32_t edge = tt->ack + tt->nwnd;
 
-            rt = i * TT_SZPL;
-            /* 滑动窗口右移i个单位 */
-            rmn -= rt;
-            buf += rt;
-            msk >>= i;
+        if (TT_SEQ_DIFF(edge, tt->awr) * 2 >= (s32_t) tt->nwnd || TT_SEQ_DIFF(tt->awr, cum) < 0) tt->awr = edge;
+        TT_SET_WND(tt, out, tt->awr - cum);
+    }
+}
 
-            tt->seq += i;
-        }
+/* 构造ACK包，返回包长。
+ * ack字段为累计确认（该序号之前的包已全部收到），负载为其后窗口内已收到的乱序包位图：
+ * 第k位（第k/8字节的第k%8位）标识序号 ack + 1 + k 的包已收到，位图末尾全0的字节不发送。
+ */
+static u16_t ack_build(tt_t* tt, u8_t* out)
+{
+    u8_t* pld = TT_GET_PLD(tt, out);
+    u32_t i;
+    u32_t k;
+    u32_t cum;
+    u16_t pl = 0;
+    u16_t crc;
 
-        if (tt->closed) {
-            tt_println("connection closed by peer");
-            break;
+    /* 累计确认跳过已连续收到（但用户还未取走）的包 */
+    i = tt->nrun;
+    cum = tt->ack + i;
+
+    /* 位图最多占满一个包的负载，超出部分不报告 */
+    tt_memset(pld, 0, TT_MPL(tt));
+    for (k = 0, ++i; i < tt->nwnd && k < TT_MPL(tt) * 8u; ++i, ++k) {
+        if (tt->blen[TT_RING(tt, tt->wnd, i)]) {
+            pld[k >> 3] |= 1 << (k & 7);
+            pl = (k >> 3) + 1;
         }
     }
 
-    return rmn > 0 ? len - rmn : len;
+    tt_println("send ACK %d, sack %d bytes", cum, pl);
+
+    tt->nack = 0;
+
+    hdr_build(tt, out, TT_ACK, tt->seq, cum, pl);
+
+    crc = crc16(tt, out, pl + tt->hsz - 2);
+    TT_SET_CRC(tt, out, pl, crc);
+
+    return tt->hsz + pl;
 }
 
-s32_t tt_recv(tt_t* tt, u8_t* buf, s32_t len, s32_t mrecv)
+/* 构造控制包（FIN、探测包、探测应答），负载为pl字节的填充数据，返回包长 */
+static u16_t ctl_build(tt_t* tt, u8_t* out, u8_t flg, u32_t ack, u16_t pl)
 {
-    u8_t tmp[TT_SZPKT];
-    u8_t* pkt;
-    s32_t rt;
-    s32_t sz = 0;
-    s32_t rcv = 0;  /* 已往buf写入的字节数 */
-    u32_t i;
-    u16_t iwnd;
-    u16_t pl;
     u16_t crc;
-    s32_t nrecv = 0; /* 当前接收次数 */
 
-    tt_println("tt_recv expect len %d", len);
+    hdr_build(tt, out, flg, tt->seq, ack, pl);
+    tt_memset(TT_GET_PLD(tt, out), 0, pl);
 
-    /* 若接收缓冲区有数据，则先拷贝到用户区 */
-    for (i = 0; i < TT_SZWND; ++i) {
-        iwnd = tt->wnd % TT_SZWND;
+    crc = crc16(tt, out, pl + tt->hsz - 2);
+    TT_SET_CRC(tt, out, pl, crc);
+
+    return tt->hsz + pl;
+}
+
+/* 尝试将负载压缩到out中负载的位置，返回压缩后的长度，没有变短（或正在退避）时返回0 */
+static u16_t lz_build(tt_t* tt, u8_t* out, const u8_t* pld, u16_t pl)
+{
+    u32_t n;
 
-        if (!tt->blen[iwnd]) break;
+    if (tt->zskip) {
+        --tt->zskip;
+        return 0;
+    }
 
-        if (len >= tt->blen[iwnd]) {
-            tt_memcpy(buf, tt->buf[iwnd], tt->blen[iwnd]);
+    n = tt_lz_compress(tt->lzh, pld, pl, TT_GET_PLD(tt, out), pl - 1u);
+    if (!n) {
+        /* 连续无收益时跳过的包个数加倍，不可压缩的数据不再每个包都尝试 */
+        tt->zmiss += tt->zmiss < TT_ZMISS;
+        tt->zskip = (u8_t) ((1u << tt->zmiss) - 1);
+        return 0;
+    }
 
-            rcv += tt->blen[iwnd];
-            buf += tt->blen[iwnd];
-            len -= tt->blen[iwnd];
+    tt->zmiss = 0;
+    tt->zsave += pl - n;
 
-            tt_println("copy to user %d bytes", tt->blen[iwnd]);
+    return (u16_t) n;
+}
 
-            /* 窗口右移一个单位 */
-            ++tt->ack;
-            ++tt->wnd;
-            tt->blen[iwnd] = 0;
+/* 待发送数据中偏移off所在的数据段 */
+static u32_t seg_find(const tt_t* tt, u32_t off)
+{
+    u32_t k = tt->nseg - 1;
 
-            /* 用户缓冲长度为0，直接返回 */
-            if (!len) return rcv;
+    while (k > 0 && tt->sbeg[k] > off) --k;
 
-        } else {
-            /* 用户缓冲长度不足，尽可能拷贝数据后返回 */
-            tt_memcpy(buf, tt->buf[iwnd], len);
+    return k;
+}
 
-            rcv += len;
-            buf += len;
+/* 待发送数据中偏移off处的地址 */
+static const u8_t* seg_ptr(const tt_t* tt, u32_t off)
+{
+    u32_t k = seg_find(tt, off);
 
-            tt_println("copy to user %d bytes", len);
+    return tt->sbuf[k] + (off - tt->sbeg[k]);
+}
 
-            tt->blen[iwnd] -= len;
-            tt_memmove(tt->buf[iwnd], tt->buf[iwnd] + len, tt->blen[iwnd]);
-            return rcv;
-        }
-    }
+/* 构造发送窗口第j个单元的数据包包头（不含负载与CRC），*pld指向用户数据中的负载，返回包长。
+ * ack字段捎带累计确认，待发送的ACK随之取消（需要位图时已在之前单独发送）。
+ * 开启压缩、对方已通告支持且压缩后变短时，压缩的负载直接写入out，与控制包一样完整构造（*pld为0）。
+ */
+static u16_t data_build(tt_t* tt, u8_t* out, u32_t seq, u32_t j, const u8_t** pld)
+{
+    u16_t pl = tt->slen[j];
+    u16_t crc;
 
-    if (tt->closed) {
-        tt_println("connection is closed");
-        return TT_ERRFINAL;
+    tt->pend &= ~TT_PACK;
+    tt->nack = 0;
+
+    *pld = seg_ptr(tt, tt->soff[j]);
+
+    if (tt->lzh && (tt->caps & TT_CLZ) && (pl = lz_build(tt, out, *pld, pl)) > 0) {
+        hdr_build(tt, out, 0, seq, tt->ack + tt->nrun, pl);
+        TT_SET_FLG(out, tt->ftag ^ TT_FLZ);
+
+        crc = crc16(tt, out, pl + tt->hsz - 2);
+        TT_SET_CRC(tt, out, pl, crc);
+
+        *pld = 0;
+        return tt->hsz + pl;
     }
 
-    while (1) {
-        rt = tt->rcb(tt->usr, tmp + sz, TT_SZPKT - sz);
-        if (rt < 0) {
-            tt_println("readcb (data) failed, return");
-            return TT_ERRRECV;
-        }
+    hdr_build(tt, out, 0, seq, tt->ack + tt->nrun, tt->slen[j]);
 
-        if (!rt) {
-            /* 如果已经接收到了数据，超时一次就返回 */
-            if (rcv > 0) {
-                tt_println("readcb (data) timeout but recved > 0, break");
-                break;
-            }
-            if (++nrecv >= mrecv) {
-                tt_println("readcb (data) timeout count reach max, break");
-                break;
-            }
-            tt_println("readcb (data) timeout");
-            continue;
-        }
+    return tt->hsz + tt->slen[j];
+}
 
-        /* 先校验第一个字节是否正确，下面再进一步校验 */
-        if ((TT_GET_FLG(tmp) & TT_FMASK) != TT_FTAG) {
-            tt_println("got an error packet (flag) first");
-            continue;
-        }
+/* 写出data_build构造的数据包。设置了分散写回调时包头、用户数据、CRC分三段写出，负载不拷贝；
+ * 开启批量发送时包头写入排队缓存，由frame_flush统一写出。
+ */
+static s32_t data_write(tt_t* tt, u8_t* out, const u8_t* pld, u16_t pl)
+{
+    tt_iov iov[3];
+    tt_iov* v = iov;
+    u16_t crc;
 
-        sz += rt;
-        /* 接收长度不足一个包 */
-        if (sz < TT_SZHDR) {
-            tt_println("packet need more (header)");
-            continue;
+    if (tt->iocb) {
+        if (tt->nbat) {
+            tt_memcpy(tt->bhdr + tt->nbq * TT_SZHDRX, out, tt->hsz - 2);
+            out = tt->bhdr + tt->nbq * TT_SZHDRX;
+            v = tt->biov + tt->nbq * 3;
         }
 
-        pkt = tmp;
-        /* 处理包 */
-        do {
-            /* 收到了错误的包（flag错误），丢弃 */
-            if ((TT_GET_FLG(pkt) & TT_FMASK) != TT_FTAG) {
-                tt_println("got an error packet (flag)");
-                sz = 0; break;
-            }
+        crc = crc16_next(tt, crc16(tt, out, tt->hsz - 2), pld, pl);
+        TT_SET_CRC(tt, out, 0, crc);
 
-            pl = TT_GET_LEN(pkt);
-            /* 收到了错误的包（负载过长），丢弃 */
-            if (pl > TT_SZPL) {
-                tt_println("got an error packet (payload)");
-                sz = 0; break;
-            }
+        v[0].buf = out;
+        v[0].len = tt->hsz - 2;
+        v[1].buf = pld;
+        v[1].len = pl;
+        v[2].buf = out + tt->hsz - 2;
+        v[2].len = 2;
 
-            /* 该包还未收完，保留 */
-            if (sz < TT_SZHDR + pl) {
-                tt_println("packet need more (payload)");
-                break;
-            }
+        if (v == iov) {
+            return tt->iocb(tt->usr, iov, 3);
+        }
 
-            crc = crc16(pkt, pl + TT_SZHDR - 2);
-            /* CRC校验失败，丢弃 */
-            if (TT_GET_CRC(pkt, pl) != crc) {
-                tt_println("got an error packet (crc)");
-                sz = 0; break;
-            }
+        /* 队列满时写出 */
+        return ++tt->nbq < tt->nbat ? 0 : frame_flush(tt);
+    }
 
-            if (TT_GET_FLG(pkt) & TT_ACK) {
-                /* 该包是ACK包，不做任何处理 */
-                tt_println("ACK recved, drop it");
-            } else if (TT_GET_FLG(pkt) & TT_FIN) {
-                /* 该包是FIN包，回传FIN包 */
-                tt_println("FIN recved, reply FIN");
-
-                /* 构造FIN包 */
-                TT_SET_SEQ(pkt, tt->seq);
-                TT_SET_ACK(pkt, tt->ack);
-                TT_SET_LEN(pkt, 0);
-
-                crc = crc16(pkt, TT_SZHDR - 2);
-                TT_SET_CRC(pkt, 0, crc);
-
-                /* 发送FIN包，告知tt->ack之前的包已全部接收到 */
-                if (tt->wcb(tt->usr, pkt, TT_SZHDR) < 0) {
-                    tt_println("writecb (FIN) failed");
-                    // TODO
-                }
+    TT_SET_PLD(tt, out, pl, pld);
 
-                tt->closed = 1;
-                break;
+    crc = crc16(tt, out, pl + tt->hsz - 2);
+    TT_SET_CRC(tt, out, pl, crc);
 
-            } else {
-                /* 该包是数据包，接收 */
-                rt = TT_GET_SEQ(pkt);
+    return frame_write(tt, out, tt->hsz + pl);
+}
+
+/* 将组内第i个包（负载长度与负载）按第j行的系数累加到row */
+static void fec_acc(u8_t* row, u32_t j, u32_t i, const u8_t* pld, u16_t pl)
+{
+    u8_t c = tt_fec_coef(j, i);
 
-                if (rt < tt->ack + TT_SZWND) {
+    row[0] ^= tt_gf_mul(c, pl >> 8);
+    row[1] ^= tt_gf_mul(c, pl & 0xff);
+    tt_gf_madd(row + 2, pld, c, pl);
+}
+
+/* 发送端编码：新包首次发送时累加到当前组，组满时登记校验包 */
+static void fec_add(tt_t* tt, u32_t seq, const u8_t* pld, u16_t pl)
+{
+    u32_t j;
 
-                    if (rt >= tt->ack && pl > 0) {
-                        i = (rt - tt->ack + tt->wnd) % TT_SZWND;
+    /* 新的一组，清空上一组用过的部分 */
+    if (!tt->fcnt) {
+        for (j = 0; j < tt->fm; ++j) {
+            tt_memset(tt->fenc + j * TT_FSZ(tt), 0, tt->fmax + 2);
+        }
+        tt->fseq = seq;
+        tt->fmax = 0;
+    }
 
-                        if (!tt->blen[i]) {
-                            /* 未收到过该包，接收并标记 */
-                            tt_memcpy(tt->buf[i], TT_GET_PLD(pkt), pl);
-                            tt->blen[i] = pl;
-                            tt_println("data packet %d recved, pl %d", rt, pl);
+    for (j = 0; j < tt->fm; ++j) {
+        fec_acc(tt->fenc + j * TT_FSZ(tt), j, tt->fcnt, pld, pl);
+    }
+    if (pl > tt->fmax) tt->fmax = pl;
 
-                            /* 将接收缓存区（tt->buf）的数据拷贝到用户区（buf） */
-                            for (i = 0; i < TT_SZWND; ++i) {
-                                iwnd = tt->wnd % TT_SZWND;
+    if (++tt->fcnt == tt->fk) {
+        tt->fpend = tt->fm;
+    }
+}
 
-                                if (!tt->blen[iwnd]) break;
+/* 构造当前组的下一个校验包，返回包长。最后一个校验包发出后当前组结束 */
+static u16_t fec_build(tt_t* tt, u8_t* out)
+{
+    u32_t j = tt->fm - tt->fpend--;
+    u16_t pl = tt->fmax + 2;
+    u16_t crc;
 
-                                if (len >= tt->blen[iwnd]) {
-                                    tt_memcpy(buf, tt->buf[iwnd], tt->blen[iwnd]);
+    hdr_build(tt, out, 0, tt->fseq, tt->fcnt << 8 | j, pl);
+    TT_SET_FLG(out, tt->ftag ^ TT_FFEC);
+    TT_SET_PLD(tt, out, pl, tt->fenc + j * TT_FSZ(tt));
 
-                                    rcv += tt->blen[iwnd];
-                                    buf += tt->blen[iwnd];
-                                    len -= tt->blen[iwnd];
+    crc = crc16(tt, out, pl + tt->hsz - 2);
+    TT_SET_CRC(tt, out, pl, crc);
 
-                                    tt_println("copy to user %d bytes", tt->blen[iwnd]);
+    tt_println("send FEC %u+%d row %d, pl %d", tt->fseq, tt->fcnt, j, pl);
 
-                                    /* 窗口右移一个单位 */
-                                    ++tt->ack;
-                                    ++tt->wnd;
-                                    tt->blen[iwnd] = 0;
+    if (!tt->fpend) tt->fcnt = 0;
 
-                                    /* 用户缓冲长度为0，跳出循环 */
-                                    if (!len) break;
-                                } else {
-                                    /* 用户缓冲长度不足，尽可能拷贝数据后跳出循环 */
-                                    tt_memcpy(buf, tt->buf[iwnd], len);
+    return tt->hsz + pl;
+}
 
-                                    rcv += len;
-                                    buf += len;
+/* 协议核心：取出下一个待发送的包。控制包完整构造到out中且*pld为0；数据包只构造包头，*pld指向负载。
+ * 顺序为：FIN、探测应答、窗口探测、能力通告、ACK（有乱序包时）、待重发的包、FEC校验包、新包、ACK（无数据包可捎带时）、探测包。
+ * 返回包长，0表示没有待发送的包。
+ */
+static u16_t out_next(tt_t* tt, u8_t* out, const u8_t** pld)
+{
+    u32_t* msk = tt->map;
+    u32_t* rtx = msk + TT_NWORD(tt->nwnd);
+    u32_t* lst = rtx + TT_NWORD(tt->nwnd);
+    u32_t j;
+    u32_t n;
 
-                                    tt_println("copy to user %d bytes", len);
+    *pld = 0;
 
-                                    tt->blen[iwnd] -= len;
-                                    tt_memmove(tt->buf[iwnd], tt->buf[iwnd] + len, tt->blen[iwnd]);
-                                    len = 0;
-                                    break;
-                                }
-                            }
+    if (tt->pend & TT_PFIN) {
+        tt->pend &= ~TT_PFIN;
+        if (tt->fin) tt->fts = tt->now;
 
-                        } else {
-                            /* 已收到过该包 */
-                            tt_println("data packet %d recved (duplicate), pl %d", rt, pl);
-                        }
+        tt_println("send FIN");
+        return ctl_build(tt, out, TT_FIN, tt->ack, 0);
+    }
 
-                    } else {
-                        /* 收到的包在窗口外，且已经收到过该包 */
-                        tt_println("data packet %d recved (duplicate and out of range), pl %d", rt, pl);
-                    }
+    if (tt->pprb) {
+        n = tt->pprb;
+        tt->pprb = 0;
 
-                    tt_println("send ACK %d", rt);
+        return ctl_build(tt, out, TT_PRB, n, 0);
+    }
 
-                    /* 构造ACK包 */
-                    TT_SET_FLG(pkt, TT_FTAG | TT_ACK);
-                    TT_SET_SEQ(pkt, tt->seq);
-                    TT_SET_ACK(pkt, rt);
-                    TT_SET_LEN(pkt, 0);
+    if (tt->pend & TT_PWND) {
+        tt->pend &= ~TT_PWND;
 
-                    crc = crc16(pkt, TT_SZHDR - 2);
-                    TT_SET_CRC(pkt, 0, crc);
+        tt_println("send window probe");
+        return ctl_build(tt, out, TT_PRB, 0, 0);
+    }
 
-                    /* 发送ACK */
-                    if (tt->wcb(tt->usr, pkt, TT_SZHDR) < 0) {
-                        tt_println("writecb (ACK) failed");
-                        // TODO
-                    }
+    if (tt->pend & TT_PCAP) {
+        tt->pend &= ~TT_PCAP;
+        ++tt->zann;
 
-                    /* 用户缓冲已满，不再继续接收 */
-                    if (!len) break;
+        tt_println("send caps 0x%x", TT_CLZ);
+        return ctl_build(tt, out, TT_PRB, TT_CAPS | TT_CLZ, 0);
+    }
 
-                } else {
-                    tt_println("data packet %d recved (out of range), pl %d", rt, pl);
-                }
+    /* 有乱序包时ACK需携带位图，单独发送；否则累计确认随之后的数据包捎带 */
+    if ((tt->pend & TT_PACK) && tt->nrcv > tt->nrun) {
+        tt->pend &= ~TT_PACK;
 
-                /* 重试次数清零 */
-                nrecv = 0;
-            }
+        return ack_build(tt, out);
+    }
 
-            pkt += TT_SZHDR + pl;
-            sz -= TT_SZHDR + pl;
-        }
-        while (sz > 0);
+    /* 先重发判定为丢失的包（不超出拥塞窗口） */
+    for (; tt->nlst > 0 && tt->lcur < tt->nsnt && tt->lcur < TT_CWND(tt); ++tt->lcur) {
+        j = TT_RING(tt, tt->sw, tt->lcur);
+        if (!TT_BGET(lst, j)) continue;
 
-        if (tt->closed) {
-            tt_println("connection closed by peer");
-            break;
-        }
+        TT_BCLR(lst, j);
+        --tt->nlst;
 
-        if (!len) break;
+        /* 判定丢失后又收到了ACK，无需重发 */
+        if (TT_BGET(msk, j)) continue;
 
-        if (sz > 0 && pkt != tmp) {
-            tt_println("recv buf left");
-            tt_memmove(tmp, pkt, sz);
-        }
-    }
+        TT_BSET(rtx, j);
+        tt->ts[j] = tt->now;
 
-    tt_println("tt_recv actual len %d", rcv);
-    return rcv;
-}
+        tt_println("send packet %u (resend), pl %d", tt->seq + tt->lcur, tt->slen[j]);
 
-s32_t tt_close(tt_t* tt, s32_t msend)
-{
-    u8_t tmp[TT_SZPKT];
-    u8_t* pkt;
-    s32_t rt;
-    s32_t sz;
-    u16_t pl;
-    u16_t crc;
-    s32_t nrecv;
+        return data_build(tt, out, tt->seq + tt->lcur++, j, pld);
+    }
 
-    if (tt->closed) {
-        tt_println("connection is already closed");
-        return 0;
+    /* 校验包紧跟在组内最后一个包之后（下一组开始编码前发完） */
+    if (tt->fpend) {
+        return fec_build(tt, out);
     }
 
-    while (msend-- > 0) {
-        /* 构造FIN包 */
-        TT_SET_FLG(tmp, TT_FTAG | TT_FIN);
-        TT_SET_SEQ(tmp, tt->seq);
-        TT_SET_ACK(tmp, tt->ack);
-        TT_SET_LEN(tmp, 0);
+    /* 左边沿前移后，新进入窗口的包立即发送 */
+    if (tt->nsnt < TT_CWND(tt) && tt->nxt < tt->stot && TT_WOPEN(tt)) {
+        j = TT_RING(tt, tt->sw, tt->nsnt);
 
-        crc = crc16(tmp, TT_SZHDR - 2);
-        TT_SET_CRC(tmp, 0, crc);
+        /* 新包不跨越数据段 */
+        n = seg_find(tt, tt->nxt);
+        n = n + 1 < tt->nseg ? tt->sbeg[n + 1] : tt->stot;
 
-        tt_println("send FIN");
+        tt->soff[j] = tt->nxt;
+        tt->slen[j] = n - tt->nxt > tt->spl ? tt->spl : n - tt->nxt;
+        tt->nxt += tt->slen[j];
+        tt->ts[j] = tt->now;
 
-        /* 发送FIN包，告知tt->ack之前的包已全部接收到 */
-        if (tt->wcb(tt->usr, tmp, TT_SZHDR) < 0) {
-            tt_println("writecb (FIN) failed");
-            return TT_ERRSEND;
-        }
+        tt_println("send packet %u, pl %d", tt->seq + tt->nsnt, tt->slen[j]);
 
-        nrecv = 0;
-        sz = 0;
-        /* 接收对方返回的FIN包 */
-        while (1) {
-            rt = tt->rcb(tt->usr, tmp + sz, TT_SZPKT - sz);
-            if (rt < 0) {
-                tt_println("readcb (FIN) failed, return");
-                return TT_ERRRECV;
-            }
+        n = data_build(tt, out, tt->seq + tt->nsnt++, j, pld);
+        if (tt->fk) fec_add(tt, tt->seq + tt->nsnt - 1, seg_ptr(tt, tt->soff[j]), tt->slen[j]);
 
-            if (!rt) {
-                if (++nrecv >= tt->mackr) {
-                    tt_println("readcb (FIN) timeout count reach max, break");
-                    break;
-                }
-                tt_println("readcb (FIN) timeout");
-                continue;
-            }
+        return n;
+    }
 
-            /* 先校验第一个字节是否正确，下面再进一步校验 */
-            if ((TT_GET_FLG(tmp) & TT_FMASK) != TT_FTAG) {
-                tt_println("got an error packet (flag) first");
-                continue;
-            }
+    /* 数据已全部发出，或窗口受限且在途的包都在本组内（之后没有新包推动确认），
+     * 不再等待组满，为已发送的部分补发校验包 */
+    if (tt->fcnt && (tt->nxt == tt->stot || tt->fseq == tt->seq)) {
+        tt->fpend = tt->fm;
 
-            sz += rt;
-            /* 接收长度不足一个包 */
-            if (sz < TT_SZHDR) {
-                tt_println("packet need more (header)");
-                continue;
-            }
+        return fec_build(tt, out);
+    }
 
-            pkt = tmp;
-            /* 处理包 */
-            do {
-                /* 收到了错误的包（flag错误），丢弃 */
-                if ((TT_GET_FLG(pkt) & TT_FMASK) != TT_FTAG) {
-                    tt_println("got an error packet (flag)");
-                    sz = 0; break;
-                }
+    /* 没有可捎带ACK的数据包 */
+    if (tt->pend & TT_PACK) {
+        tt->pend &= ~TT_PACK;
 
-                pl = TT_GET_LEN(pkt);
-                /* 收到了错误的包（负载过长），丢弃 */
-                if (pl > TT_SZPL) {
-                    tt_println("got an error packet (payload)");
-                    sz = 0; break;
-                }
+        return ack_build(tt, out);
+    }
 
-                /* 该包还未收完，保留 */
-                if (sz < TT_SZHDR + pl) {
-                    tt_println("packet need more (payload)");
-                    break;
-                }
+    /* 探测更大的负载长度 */
+    if (tt->probe && !tt->ppl && tt->ngood >= TT_PRBCNT) {
+        n = tt->pbad ? (tt->spl + tt->pbad) / 2 : tt->spl * 2;
+        if (n > (u32_t) TT_DPL(tt)) n = TT_DPL(tt);
 
-                crc = crc16(pkt, pl + TT_SZHDR - 2);
-                /* CRC校验失败，丢弃 */
-                if (TT_GET_CRC(pkt, pl) != crc) {
-                    tt_println("got an error packet (crc)");
-                    sz = 0; break;
-                }
+        tt->ngood = 0;
 
-                if (TT_GET_FLG(pkt) & TT_FIN) {
-                    /* 该包是FIN包 */
-                    tt_println("FIN recved, return");
-                    tt->closed = 1;
-                    return 0;
-                }
+        if (n > tt->spl) {
+            tt_println("send probe, pl %d", n);
 
-                pkt += TT_SZHDR + pl;
-                sz -= TT_SZHDR + pl;
-            }
-            while (sz > 0);
+            tt->ppl = n;
+            tt->pts = tt->now;
 
-            if (sz > 0 && pkt != tmp) {
-                tt_println("recv buf left");
-                tt_memmove(tmp, pkt, sz);
-            }
+            return ctl_build(tt, out, TT_PRB, tt->ack, n);
         }
     }
 
     return 0;
 }
 
-s32_t tt_wait(tt_t* tt, s32_t mrecv)
+/* 写出所有待发送的包，返回小于0表示写出失败 */
+static s32_t out_flush(tt_t* tt)
 {
-    u8_t tmp[TT_SZPKT];
-    u8_t* pkt;
-    s32_t rt;
-    s32_t sz = 0;
-    u16_t pl;
-    u16_t crc;
+    u8_t* out = tt->txb;
+    const u8_t* pld;
+    u16_t n;
 
-    if (!tt->closed) {
-        tt_println("connection is not closed, return");
+    while ((n = out_next(tt, out, &pld)) > 0) {
+        if ((pld ? data_write(tt, out, pld, n - tt->hsz) : frame_write(tt, out, n)) < 0) {
+            return -1;
+        }
+    }
+
+    /* 批量发送时本轮排队的包一次写出 */
+    return frame_flush(tt);
+}
+
+/* 快速重传：未确认的包之后已有tt->dupk个包被确认时判定为丢失，不等超时立即重发。
+ * 重发过的包不再按此判定，再次丢失时由超时重传处理。
+ */
+static u32_t ack_loss(tt_t* tt)
+{
+    u32_t* msk = tt->map;
+    u32_t* rtx = msk + TT_NWORD(tt->nwnd);
+    u32_t* lst = rtx + TT_NWORD(tt->nwnd);
+    u32_t cnt = 0;  /* 当前包之后已确认的包个数 */
+    u32_t nlost = 0;
+    u32_t i = tt->nsnt;
+    u32_t k = tt->dupk;
+    u32_t j;
+
+    /* 提前重传：已发送的包不足dupk + 1个（拥塞窗口较小）时降低阈值，避免只能等超时 */
+    if (tt->early && k >= tt->nsnt) k = tt->nsnt > 1 ? tt->nsnt - 1 : 1;
+
+    while (i-- > 0) {
+        j = TT_RING(tt, tt->sw, i);
+        if (TT_BGET(msk, j)) {
+            ++cnt;
+            continue;
+        }
+
+        if (cnt < k || TT_BGET(rtx, j) || TT_BGET(lst, j)) continue;
+
+        TT_BSET(lst, j);
+        ++tt->nlst;
+        ++nlost;
+        if (i < tt->lcur) tt->lcur = i;
+
+        tt_println("packet %u lost (%d acked after it), fast resend", tt->seq + i, cnt);
+    }
+
+    return nlost;
+}
+
+/* 进入快速恢复并通知拥塞控制：窗口内当前已发送的包全部确认之前不再重复降窗 */
+static void cc_loss(tt_t* tt, u8_t timeout)
+{
+    if (!tt->cc) return;
+    if (!timeout && tt->crcv) return;
+
+    tt->crcv = 1;
+    tt->crec = tt->seq + tt->nsnt;
+    tt->cc->loss(tt, timeout);
+
+    tt_println("congestion (%s), cwnd %u ssth %u", timeout ? "timeout" : "loss", tt->cwnd, tt->ssth);
+}
+
+/* 处理ACK包：ack字段为累计确认，负载为乱序包位图 */
+static void ack_input(tt_t* tt, u8_t* pkt, u16_t pl)
+{
+    u32_t* msk = tt->map;
+    u32_t* rtx = msk + TT_NWORD(tt->nwnd);
+    u32_t* lst = rtx + TT_NWORD(tt->nwnd);
+    u32_t ack = seq_ext(tt->seq, TT_GET_ACK(pkt));
+    s32_t d = TT_SEQ_DIFF(ack, tt->seq);
+    u32_t n = 0;    /* 本ACK新确认的最后一个未重发过（也未登记待重发）的包 + 1，用于RTT采样 */
+    u32_t na = 0;   /* 本ACK新确认的包个数 */
+    u32_t rtt = 0;
+    u32_t k = tt->ngood;
+    u32_t i;
+    u32_t j;
+
+    /* ack之前的包已全部收到 */
+    for (i = 0; d > 0 && i < (u32_t) d && i < tt->nsnt; ++i) {
+        j = TT_RING(tt, tt->sw, i);
+        if (TT_BGET(msk, j)) continue;
+
+        TT_BSET(msk, j);
+        ++na;
+        if (TT_BGET(rtx, j)) continue;
+
+        ++k;
+        /* 超时后登记待重发的包，确认可能来自之前重发的包触发的ACK，不用于采样 */
+        if (!TT_BGET(lst, j)) n = i + 1;
+    }
+    tt->ngood = k > 0xffff ? 0xffff : k;
+
+    for (k = 0; k < pl * 8u; ++k) {
+        if (!(TT_GET_PLD(tt, pkt)[k >> 3] & (1 << (k & 7)))) continue;
+
+        if (d + 1 + (s32_t) k < 0) continue;
+
+        i = d + 1 + k;
+        if (i >= tt->nsnt) continue;
+
+        j = TT_RING(tt, tt->sw, i);
+        if (TT_BGET(msk, j)) continue;
+
+        TT_BSET(msk, j);
+        ++na;
+        if (TT_BGET(rtx, j)) continue;
+
+        if (i + 1 > n && !TT_BGET(lst, j)) n = i + 1;
+        tt->ngood += tt->ngood < 0xffff;
+    }
+
+    if (TT_TIMED(tt) && n > 0) {
+        rtt = tt->now - tt->ts[TT_RING(tt, tt->sw, n - 1)];
+        rtt_sample(tt, rtt);
+    }
+
+    if (tt->cc && na > 0) {
+        tt->cc->ack(tt, na, rtt);
+    }
+
+    /* 对方通告的接收窗口（只前移） */
+    if ((tt->ftag & TT_FWND) && TT_SEQ_DIFF(ack + TT_GET_WND(tt, pkt), tt->rwr) > 0) {
+        tt->rwr = ack + TT_GET_WND(tt, pkt);
+        tt->wnum = 0;
+    }
+
+    /* 位图中有确认时窗口内才可能有空缺 */
+    if (tt->dupk && pl > 0 && ack_loss(tt)) {
+        cc_loss(tt, 0);
+    }
+
+    tt_println("ACK %u recved, sack %d bytes", ack, pl);
+}
+
+/* 使用缓存池时为接收缓存第i个单元借用空间，ord表示该包按序到达（可使用池的保留单元）。
+ * 池已用完时改用本连接为FEC保留的已交付单元（放弃用其解码），都没有时返回0（按未收到该包处理）
+ */
+static u8_t* buf_get(tt_t* tt, u32_t i, u8_t ord)
+{
+    u32_t j;
+
+    if (tt->bptr && !tt->bptr[i]) {
+        tt->bptr[i] = tt_pool_get(tt->pool, ord);
+
+        for (j = 0; !tt->bptr[i] && tt->fk && j < tt->nwnd; ++j) {
+            if (tt->bptr[j] && !tt->blen[j]) {
+                tt->bptr[i] = tt->bptr[j];
+                tt->bptr[j] = 0;
+            }
+        }
+
+        if (!tt->bptr[i]) {
+            tt_println("buffer pool exhausted (%u used)", tt->pool->nused);
+            return 0;
+        }
+    }
+
+    return TT_BUF(tt, i);
+}
+
+/* 归还接收缓存第i个单元 */
+static void buf_put(tt_t* tt, u32_t i)
+{
+    if (tt->bptr && tt->bptr[i]) {
+        tt_pool_put(tt->pool, tt->bptr[i]);
+        tt->bptr[i] = 0;
+    }
+}
+
+/* 尝试解码一组：组内已收到的包（包括已交给用户、接收缓存单元还未被覆盖的包）从校验行中消去后，
+ * 剩下缺失包的线性组合，缺失的包数不超过已收到的校验行数时求逆解出，存入接收缓存。
+ * 整组已收到、无法再解码（缓存单元已被覆盖）或解码完成时释放该组。
+ */
+static void fec_try(tt_t* tt, tt_fgrp* g)
+{
+    u8_t* par = tt->facc + (u32_t) (g - tt->fgrp) * tt->fm * TT_FSZ(tt);
+    u8_t a[TT_FECM * TT_FECM];
+    u8_t row[TT_FECM];
+    u8_t mis[TT_FECM];
+    u32_t ne = 0;
+    u32_t nr = 0;
+    u32_t i;
+    u32_t r;
+    u32_t k;
+    s32_t rt;
+    u16_t len;
+    u8_t* dst;
+
+    for (i = 0; i < g->n; ++i) {
+        rt = TT_SEQ_DIFF(g->seq + i, tt->ack);
+        k = TT_RING(tt, tt->wnd, rt < 0 ? rt + tt->nwnd : rt);
+
+        if (rt < 0 ? tt->bseq[k] == g->seq + i && (!tt->bptr || tt->bptr[k]) : tt->blen[k] > 0) continue;
+
+        /* 已交给用户的包所在单元已被新包覆盖 */
+        if (rt < 0) {
+            g->n = 0;
+            return;
+        }
+
+        if (ne == TT_FECM) return;
+        mis[ne++] = (u8_t) i;
+    }
+
+    if (!ne) {
+        g->n = 0;
+        return;
+    }
+
+    for (r = 0; r < tt->fm && nr < ne; ++r) {
+        if (g->rows >> r & 1) row[nr++] = (u8_t) r;
+    }
+
+    if (nr < ne) return;
+
+    for (r = 0; r < ne; ++r) {
+        for (i = 0; i < ne; ++i) {
+            a[r * ne + i] = tt_fec_coef(row[r], mis[i]);
+        }
+    }
+
+    if (tt_fec_inv(a, ne) < 0) return;
+
+    /* 各校验行消去已收到的包 */
+    for (i = 0, k = 0; i < g->n; ++i) {
+        if (k < ne && mis[k] == i) {
+            ++k;
+            continue;
+        }
+
+        rt = TT_SEQ_DIFF(g->seq + i, tt->ack);
+        dst = TT_BUF(tt, TT_RING(tt, tt->wnd, rt < 0 ? rt + tt->nwnd : rt));
+        len = tt->bpl[TT_RING(tt, tt->wnd, rt < 0 ? rt + tt->nwnd : rt)];
+
+        for (r = 0; r < ne; ++r) {
+            fec_acc(par + row[r] * TT_FSZ(tt), row[r], i, dst, len);
+        }
+    }
+
+    /* 第i个缺失包 = sum(a[i][r] * 第row[r]行) */
+    for (i = 0; i < ne; ++i) {
+        len = 0;
+        for (r = 0; r < ne; ++r) {
+            dst = par + row[r] * TT_FSZ(tt);
+            len ^= tt_gf_mul(a[i * ne + r], dst[0]) << 8 | tt_gf_mul(a[i * ne + r], dst[1]);
+        }
+
+        if (!len || len + 2 > g->len) {
+            tt_println("FEC %u+%d decode error, pl %d", g->seq, g->n, len);
+            break;
+        }
+
+        rt = TT_SEQ_DIFF(g->seq + mis[i], tt->ack);
+        k = TT_RING(tt, tt->wnd, rt);
+        dst = buf_get(tt, k, 0);
+        if (!dst) break;
+
+        tt_memset(dst, 0, len);
+        for (r = 0; r < ne; ++r) {
+            tt_gf_madd(dst, par + row[r] * TT_FSZ(tt) + 2, a[i * ne + r], len);
+        }
+
+        tt->blen[k] = len;
+        tt->boff[k] = 0;
+        tt->bseq[k] = g->seq + mis[i];
+        tt->bpl[k] = len;
+        ++tt->nrcv;
+        ++tt->nfec;
+        tt_println("data packet %u recovered (FEC), pl %d", g->seq + mis[i], len);
+    }
+
+    g->n = 0;
+
+    while (tt->nrun < tt->nwnd && tt->blen[TT_RING(tt, tt->wnd, tt->nrun)]) ++tt->nrun;
+
+    /* 立即确认恢复的包，对方不再重发 */
+    tt->pend |= TT_PACK;
+}
+
+/* 收到新的数据包后，重新尝试解码包含该包的组 */
+static void fec_data(tt_t* tt, u32_t seq)
+{
+    tt_fgrp* g;
+    u32_t i;
+
+    for (i = 0; i < tt->ngrp; ++i) {
+        g = tt->fgrp + i;
+        if (g->n && (u32_t) TT_SEQ_DIFF(seq, g->seq) < g->n) fec_try(tt, g);
+    }
+}
+
+/* 处理FEC校验包：组内有缺失时保存该校验行并尝试解码。
+ * 分组槽位不足时替换最早的组。
+ */
+static void fec_input(tt_t* tt, u8_t* pkt, u16_t pl)
+{
+    u32_t seq = seq_ext(tt->ack, TT_GET_SEQ(pkt));
+    u32_t n = TT_GET_ACK(pkt) >> 8;
+    u32_t j = TT_GET_ACK(pkt) & 0xff;
+    tt_fgrp* g;
+    u32_t i;
+
+    tt_println("FEC %u+%d row %d recved, pl %d", seq, n, j, pl);
+
+    /* 组内已全部按序收到，或超出接收窗口 */
+    if (!n || n > tt->fk || j >= tt->fm || pl < 2 || pl > TT_FSZ(tt)
+        || TT_SEQ_DIFF(seq + n, tt->ack + tt->nrun) <= 0 || TT_SEQ_DIFF(seq + n, tt->ack + tt->nwnd) > 0) {
+        return;
+    }
+
+    for (i = 0; i < tt->ngrp; ++i) {
+        g = tt->fgrp + i;
+        if (g->n == n && g->seq == seq) break;
+    }
+
+    /* 新的组：取空闲槽位，没有时替换最早的组 */
+    if (i == tt->ngrp) {
+        for (g = tt->fgrp, i = 1; i < tt->ngrp && g->n; ++i) {
+            if (!tt->fgrp[i].n || TT_SEQ_DIFF(tt->fgrp[i].seq, g->seq) < 0) g = tt->fgrp + i;
+        }
+
+        g->seq = seq;
+        g->n = (u8_t) n;
+        g->len = pl;
+        g->rows = 0;
+    }
+
+    if ((g->rows >> j & 1) || g->len != pl) return;
+
+    tt_memcpy(tt->facc + ((u32_t) (g - tt->fgrp) * tt->fm + j) * TT_FSZ(tt), TT_GET_PLD(tt, pkt), pl);
+    g->rows |= 1 << j;
+
+    fec_try(tt, g);
+}
+
+/* 处理数据包：窗口内的包存入接收缓存，并按ACK策略登记回复ACK */
+static void data_input(tt_t* tt, u8_t* pkt, u16_t pl)
+{
+    u32_t run = tt->nrun;
+    u8_t now = 1;   /* 是否需要立即回复ACK */
+    s32_t rt;
+    s32_t n;
+    u32_t i;
+
+    /* rt为该包相对tt->ack的偏移 */
+    rt = TT_SEQ_DIFF(seq_ext(tt->ack, TT_GET_SEQ(pkt)), tt->ack);
+
+    if (rt >= tt->nwnd) {
+        /* 立即回复，对方据此得知窗口（或重新同步） */
+        tt_println("data packet %u recved (out of range), pl %d", tt->ack + rt, pl);
+        tt->pend |= TT_PACK;
+        return;
+    }
+
+    if (rt >= 0 && pl > 0) {
+        i = TT_RING(tt, tt->wnd, rt);
+
+        if (!tt->blen[i]) {
+            /* 未收到过该包，接收（压缩的包解压）并标记；缓存池已用完时不确认，等待重发 */
+            if (!buf_get(tt, i, (u32_t) rt == tt->nrun)) return;
+
+            if ((TT_GET_FLG(pkt) & TT_FMASK) != tt->ftag) {
+                /* 对方已开始压缩，不再通告 */
+                tt->zann = TT_ZANN;
+                n = tt_lz_decompress(TT_GET_PLD(tt, pkt), pl, TT_BUF(tt, i), TT_MPL(tt));
+                if (n <= 0) {
+                    /* CRC正确但无法解压（对方实现有误），不确认，等待重发 */
+                    tt_println("data packet %u recved, decompress failed", tt->ack + rt);
+                    buf_put(tt, i);
+                    return;
+                }
+                pl = (u16_t) n;
+            } else {
+                tt_memcpy(TT_BUF(tt, i), TT_GET_PLD(tt, pkt), pl);
+                /* 本端开启压缩时通告支持压缩包，对方收到后才开始压缩（通告可能丢失，随之后的数据包重发几次） */
+                if (tt->lzh && tt->zann < TT_ZANN) tt->pend |= TT_PCAP;
+            }
+            tt->blen[i] = pl;
+            tt->boff[i] = 0;
+            ++tt->nrcv;
+            tt_println("data packet %u recved, pl %d", tt->ack + rt, pl);
+
+            /* 更新连续收到的包个数 */
+            while (tt->nrun < tt->nwnd && tt->blen[TT_RING(tt, tt->wnd, tt->nrun)]) ++tt->nrun;
+
+            if (tt->fk) {
+                tt->bseq[i] = tt->ack + rt;
+                tt->bpl[i] = pl;
+                fec_data(tt, tt->ack + rt);
+            }
+
+            /* 按序到达且未填补空缺时可以延迟回复 */
+            now = tt->nrun != run + 1;
+
+        } else {
+            /* 已收到过该包 */
+            tt_println("data packet %u recved (duplicate), pl %d", tt->ack + rt, pl);
+        }
+
+    } else {
+        /* 收到的包在窗口外，且已经收到过该包 */
+        tt_println("data packet %u recved (duplicate and out of range), pl %d", tt->ack + rt, pl);
+    }
+
+    /* 乱序、重复、填补空缺时立即回复，便于对方尽快重发；否则按策略（默认本次处理的包全部处理完后）统一回复 */
+    if (!tt->nack++) tt->ats = tt->now;
+
+    if (now || (!tt->ackn && !tt->ackd) || (tt->ackn && tt->nack >= tt->ackn)) {
+        tt->pend |= TT_PACK;
+    }
+}
+
+/* 从左边沿开始连续收到ACK的包移出发送窗口 */
+static void snd_slide(tt_t* tt)
+{
+    u32_t* msk = tt->map;
+    u32_t* rtx = msk + TT_NWORD(tt->nwnd);
+    u32_t* lst = rtx + TT_NWORD(tt->nwnd);
+    u32_t i;
+    u32_t j;
+
+    for (i = 0; i < tt->nsnt; ++i) {
+        j = TT_RING(tt, tt->sw, i);
+        if (!TT_BGET(msk, j)) break;
+
+        TT_BCLR(msk, j);
+        TT_BCLR(rtx, j);
+        if (TT_BGET(lst, j)) {
+            TT_BCLR(lst, j);
+            --tt->nlst;
+        }
+        tt->una += tt->slen[j];
+    }
+
+    /* 已全部确认的数据段移出 */
+    while (tt->nseg > 1 && tt->una >= tt->sbeg[1]) {
+        for (j = 1; j < tt->nseg; ++j) {
+            tt->sbuf[j - 1] = tt->sbuf[j];
+            tt->sbeg[j - 1] = tt->sbeg[j];
+        }
+        --tt->nseg;
+    }
+
+    /* 此时i为收到连续ACK的个数 */
+    if (i > 0) {
+        tt_println("send window >> %d", i);
+
+        /* 滑动窗口右移i个单位 */
+        tt->sw = TT_RING(tt, tt->sw, i);
+        tt->nsnt -= i;
+        tt->lcur = tt->lcur > i ? tt->lcur - i : 0;
+        tt->seq += i;
+
+        /* 进入恢复时已发送的包全部确认，退出快速恢复 */
+        if (tt->crcv && TT_SEQ_DIFF(tt->seq, tt->crec) >= 0) tt->crcv = 0;
+    }
+}
+
+/* 协议核心：处理接收环中所有完整的包，更新收发状态并登记需要回复的包，返回收到的数据包个数 */
+static s32_t frame_input(tt_t* tt)
+{
+    u32_t* msk = tt->map;
+    u8_t* pkt;
+    u32_t ack;
+    s32_t ndat = 0;
+    s32_t d;
+    u16_t pl;
+    u16_t i;
+
+    while ((pkt = frame_next(tt))) {
+        pl = TT_GET_LEN(pkt);
+
+        /* 重试次数清零 */
+        tt->nsend = 0;
+
+        if ((TT_GET_FLG(pkt) & TT_FMASK) == (tt->ftag ^ TT_FFEC)) {
+            /* FEC校验包（frame_next只放行本端开启FEC时的校验包） */
+            fec_input(tt, pkt, pl);
+
+        } else if ((TT_GET_FLG(pkt) & TT_PRB) == TT_PRB) {
+            /* 该包是探测包则登记探测应答；是探测应答则增大发送负载；是能力通告则记录对方支持的功能 */
+            if (pl > 0) {
+                tt->pprb = pl;
+            } else if (TT_GET_ACK(pkt) & TT_CAPS) {
+                tt_println("caps 0x%x recved", TT_GET_ACK(pkt) & ~TT_CAPS);
+                tt->caps = (u16_t) (TT_GET_ACK(pkt) & ~TT_CAPS);
+            } else if (tt->ppl && TT_GET_ACK(pkt) == tt->ppl) {
+                tt_println("probe ACK recved, pl %d -> %d", tt->spl, tt->ppl);
+                tt->spl = tt->ppl;
+                tt->ppl = 0;
+                tt->pnum = 0;
+            } else if (!TT_GET_ACK(pkt)) {
+                /* 窗口探测，回复ACK通告当前窗口 */
+                tt->pend |= TT_PACK;
+            }
+
+        } else if (TT_GET_FLG(pkt) & TT_ACK) {
+            ack_input(tt, pkt, pl);
+
+        } else if (TT_GET_FLG(pkt) & TT_FIN) {
+            /* 该包是FIN包，表示TT_GET_ACK(pkt)之前的包已全部收到 */
+            ack = seq_ext(tt->seq, TT_GET_ACK(pkt));
+            d = TT_SEQ_DIFF(ack, tt->seq);
+
+            if (d > 0 && d <= (s32_t) tt->nsnt) {
+                for (i = 0; i < d; ++i) {
+                    TT_BSET(msk, TT_RING(tt, tt->sw, i));
+                }
+            }
+
+            /* 本端主动关闭时该包是对方的回复，否则回复FIN */
+            if (tt->fin) {
+                tt_println("FIN %u recved", ack);
+            } else {
+                tt_println("FIN %u recved, reply FIN", ack);
+                tt->pend |= TT_PFIN;
+            }
+
+            tt->closed = 1;
+            break;
+
+        } else {
+            /* 数据包的ack字段为捎带的累计确认 */
+            ack_input(tt, pkt, 0);
+            data_input(tt, pkt, pl);
+            ++ndat;
+        }
+    }
+
+    snd_slide(tt);
+
+    return ndat;
+}
+
+/* 延迟ACK定时：未回复的数据包等待超过tt->ackd时登记ACK。force为1表示不比较时间（如读超时） */
+static void ack_timer(tt_t* tt, u8_t force)
+{
+    if (!tt->nack || (tt->pend & TT_PACK)) return;
+
+    if (force || (TT_TIMED(tt) && tt->ackd && tt->now - tt->ats >= tt->ackd)) {
+        tt_println("delayed ACK, %d packets", tt->nack);
+        tt->pend |= TT_PACK;
+    }
+}
+
+/* 协议核心：重传定时（延迟ACK、探测包、主动FIN、发送窗口左边沿）。
+ * force为1表示调用者已按读超时次数判定超时（未设置时钟），此时不比较时间。
+ */
+static void snd_timer(tt_t* tt, u8_t force)
+{
+    u32_t* msk = tt->map;
+    u32_t* rtx = msk + TT_NWORD(tt->nwnd);
+    u32_t* lst = rtx + TT_NWORD(tt->nwnd);
+    u32_t i;
+    u32_t j;
+
+    ack_timer(tt, force);
+
+    /* 探测包超时未应答，同一长度连续失败TT_PRBMAX次则记录为不可用的负载长度 */
+    if (tt->ppl && (force || tt->now - tt->pts >= tt->rto)) {
+        tt_println("probe timeout, pl %d", tt->ppl);
+        if (++tt->pnum >= TT_PRBMAX) {
+            tt->pbad = tt->ppl;
+            tt->pnum = 0;
+        }
+        tt->ppl = 0;
+    }
+
+    /* 主动发送的FIN超时未回复，重发 */
+    if (tt->fin && !tt->closed && !(tt->pend & TT_PFIN) && (force || tt->now - tt->fts >= tt->rto)) {
+        tt_println("FIN timeout, resend");
+        tt->pend |= TT_PFIN;
+        ++tt->nsend;
+        rto_backoff(tt);
+    }
+
+    /* 对方窗口已满且没有在途的包，定时发送窗口探测，防止窗口更新丢失后一直等待 */
+    if (!tt->nsnt && tt->nxt < tt->stot && !TT_WOPEN(tt) && (force || tt->now - tt->wts >= TT_WIVL(tt))) {
+        tt->pend |= TT_PWND;
+        tt->wts = tt->now;
+        tt->wnum += tt->wnum < 16;
+        ++tt->nsend;
+    }
+
+    /* 窗口左边沿超时未确认，重发已发送但未确认的包 */
+    if (!tt->nsnt) return;
+    if (!force && tt->now - tt->ts[tt->sw] < tt->rto) return;
+
+    /* 左边沿已登记待重发（受拥塞窗口限制还未取出）时不重复判定 */
+    if (!force && TT_BGET(lst, tt->sw)) return;
+
+    ++tt->nsend;
+
+    for (i = 0; i < tt->nsnt; ++i) {
+        j = TT_RING(tt, tt->sw, i);
+        if (TT_BGET(msk, j) || TT_BGET(lst, j)) continue;
+
+        /* 按时间判定时只重发发出后已超过RTO的包 */
+        if (!force && tt->now - tt->ts[j] < tt->rto) continue;
+
+        TT_BSET(lst, j);
+        ++tt->nlst;
+    }
+    tt->lcur = 0;
+
+    tt_println("ACK timeout, resend %d packets", tt->nlst);
+
+    /* 探测模式下连续两次超时，认为当前负载过大，减半 */
+    if (tt->probe && tt->nsend >= 2 && tt->spl > TT_SZPL) {
+        tt->pbad = tt->spl;
+        tt->spl = tt->spl / 2 > TT_SZPL ? tt->spl / 2 : TT_SZPL;
+        tt_println("payload back off to %d", tt->spl);
+    }
+    tt->ngood = 0;
+
+    cc_loss(tt, 1);
+    rto_backoff(tt);
+}
+
+/* 使用缓存池时归还交付完的第i个单元。开启FEC时交给用户的包还可能用于解码同组缺失的包，保留到其后fk个包交付
+ * （组最多fk个包，此时包含该包的组已全部收到），即归还第i - fk个单元（未存入新的包时）；
+ * 池中只剩保留给按序到达的包的单元时不再保留，避免占住其他连接填补空缺需要的单元
+ */
+static void deliver_put(tt_t* tt, u32_t i)
+{
+    tt_pool* pool = tt->pool;
+
+    if (!tt->bptr) return;
+
+    if (tt->fk && !(pool->nmax && pool->nused + pool->nresv >= pool->nmax)) {
+        i = TT_RING(tt, i, tt->nwnd - tt->fk);
+        if (tt->blen[i]) return;
+    }
+
+    buf_put(tt, i);
+}
+
+/* 将接收缓存中按序到达的数据交给用户：buf不为空时拷贝到buf，为空时仅释放（零拷贝接收）。
+ * 返回交付的字节数，完整交付的包移出窗口。
+ */
+static s32_t deliver(tt_t* tt, u8_t* buf, s32_t len)
+{
+    s32_t rcv = 0;
+    u16_t n;
+    u16_t iwnd;
+
+    while (len > 0 && tt->blen[tt->wnd]) {
+        iwnd = tt->wnd;
+        n = len < tt->blen[iwnd] ? len : tt->blen[iwnd];
+
+        if (buf) {
+            tt_memcpy(buf, TT_BUF(tt, iwnd) + tt->boff[iwnd], n);
+            buf += n;
+            tt_println("copy to user %d bytes", n);
+        }
+
+        rcv += n;
+        len -= n;
+        tt->blen[iwnd] -= n;
+        tt->boff[iwnd] += n;
+
+        /* 用户缓冲长度不足时只取走部分数据，记录偏移 */
+        if (tt->blen[iwnd]) break;
+
+        /* 窗口右移一个单位 */
+        tt->boff[iwnd] = 0;
+        deliver_put(tt, iwnd);
+        tt->wnd = TT_RING(tt, tt->wnd, 1);
+        ++tt->ack;
+        --tt->nrun;
+        --tt->nrcv;
+    }
+
+    /* 通告过的窗口剩余不足一半而右边沿已能前移半个窗口以上，主动通告 */
+    if ((tt->ftag & TT_FWND) && TT_SEQ_DIFF(tt->awr, tt->ack + tt->nrun) * 2 < (s32_t) tt->nwnd
+        && TT_SEQ_DIFF(tt->ack + tt->nwnd, tt->awr) * 2 >= (s32_t) tt->nwnd) {
+        tt->pend |= TT_PACK;
+    }
+
+    return rcv;
+}
+
+/* 阻塞接口的交付：空出窗口需要通告时立即发送，不等下一次读超时 */
+static s32_t deliver_flush(tt_t* tt, u8_t* buf, s32_t len)
+{
+    s32_t rcv = deliver(tt, buf, len);
+
+    if ((tt->pend & TT_PACK) && out_flush(tt) < 0) {
+        tt_println("writecb (window update) failed");
+    }
+
+    return rcv;
+}
+
+/* 读取一次，并处理接收环中的包（可能有多个）：数据包存入接收缓存，回复ACK/FIN/探测应答。
+ * 返回读取的字节数（0表示超时），TT_ERRRECV表示读出错，TT_ERRSEND表示回复写出失败。
+ */
+static s32_t recv_data(tt_t* tt)
+{
+    s32_t n;
+
+    n = frame_read(tt);
+    if (n < 0) {
+        return TT_ERRRECV;
+    }
+
+    if (tt->clk) tt->now = tt->clk(tt->usr);
+
+    frame_input(tt);
+
+    /* 延迟的ACK到期时回复，读超时也视为到期 */
+    ack_timer(tt, !n);
+
+    /* 一次读取的所有数据包只回复一个ACK（累计确认 + 乱序位图） */
+    if (tt->pend && out_flush(tt) < 0) {
+        tt_println("writecb (ACK) failed");
+        return TT_ERRSEND;
+    }
+
+    return n;
+}
+
+/* 检查tt_init/tt_init_mem的窗口大小与mtu */
+static s32_t init_check(u16_t nwnd, u16_t mtu)
+{
+    if (nwnd < 1 || nwnd > TT_MAXWND) {
+        tt_println("invalid window size %d", nwnd);
+        return TT_ERRMEM;
+    }
+
+    if (mtu <= TT_SZHDR || mtu > 0x7fff) {
+        tt_println("invalid mtu %d", mtu);
+        return TT_ERRMEM;
+    }
+
+    return 0;
+}
+
+/* 划分窗口缓存（布局见TT_MEMSZ）：ts、位图、soff、slen、blen、boff、接收环（含mtu字节预留区）、发送帧缓存、buf，
+ * 并设置其余初始状态
+ */
+static void init_mem(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr, u8_t* mem, u32_t rsz)
+{
+    tt->ts = (u32_t*) mem;
+    tt->map = tt->ts + nwnd;
+    tt->soff = tt->map + 3 * TT_NWORD(nwnd);
+    tt->slen = (u16_t*) (tt->soff + nwnd);
+    tt->blen = tt->slen + nwnd;
+    tt->boff = tt->blen + nwnd;
+    tt->rxb = (u8_t*) (tt->boff + nwnd);
+    tt->txb = tt->rxb + rsz + mtu;
+    tt->buf = tt->txb + mtu;
+    tt->rsz = rsz;
+    tt->nwnd = nwnd;
+    tt->mtu = mtu;
+    tt->ftag = TT_FTAG;
+    tt->hsz = TT_SZHDR;
+    tt->spl = mtu - TT_SZHDR;
+
+    tt_memset((void*) tt->blen, 0, nwnd * sizeof(u16_t));
+
+    tt->rcb = rcb;
+    tt->wcb = wcb;
+    tt->mackr = mackr;
+    tt->usr = usr;
+    tt->rto = TT_RTOINIT;
+    tt->dupk = TT_DUPK;
+    tt->early = 1;
+
+    tt_set_cc(tt, &tt_cc_aimd);
+}
+
+s32_t tt_init(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr)
+{
+    u32_t rsz = 1;
+    u8_t* mem;
+
+    tt_memset((void*) tt, 0, sizeof(tt_t));
+
+    if (init_check(nwnd, mtu) < 0) return TT_ERRMEM;
+
+    /* 接收环大小取不小于TT_SZRXB及2*mtu的2的幂 */
+#if TT_SZRXB > 0
+    while (rsz < TT_SZRXB) rsz <<= 1;
+#endif
+    while (rsz < 2u * mtu) rsz <<= 1;
+
+    /* 发送/接收窗口缓存一次分配 */
+    mem = tt_malloc(TT_MEMSZ(nwnd, mtu, rsz));
+    if (!mem) {
+        tt_println("malloc window failed");
+        return TT_ERRMEM;
+    }
+
+    init_mem(tt, rcb, wcb, nwnd, mtu, mackr, usr, mem, rsz);
+
+    return 0;
+}
+
+s32_t tt_init_pool(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr, tt_pool* pool)
+{
+    u32_t rsz = 1, min = TT_SZRXP;
+    u8_t* mem;
+
+    tt_memset((void*) tt, 0, sizeof(tt_t));
+
+    if (init_check(nwnd, mtu) < 0) return TT_ERRMEM;
+
+    if (pool->bsz < (u32_t) mtu - TT_SZHDR) {
+        tt_println("pool unit too small (%u < %d)", pool->bsz, mtu - TT_SZHDR);
+        return TT_ERRMEM;
+    }
+
+    /* 接收环默认只取2*mtu，连接很多时每个连接的接收环不占用TT_SZRXB */
+    if (min < 2u * mtu) min = 2u * mtu;
+    while (rsz < min) rsz <<= 1;
+
+    /* 单元指针表在前，其后与tt_init相同但不含接收缓存 */
+    mem = tt_malloc(nwnd * sizeof(u8_t*) + TT_MEMSZ(nwnd, mtu, rsz) - (u32_t) nwnd * (mtu - TT_SZHDR));
+    if (!mem) {
+        tt_println("malloc window failed");
+        return TT_ERRMEM;
+    }
+
+    init_mem(tt, rcb, wcb, nwnd, mtu, mackr, usr, mem + nwnd * sizeof(u8_t*), rsz);
+
+    tt->bptr = (u8_t**) mem;
+    tt->pool = pool;
+    tt->buf = 0;
+    tt_memset((void*) tt->bptr, 0, nwnd * sizeof(u8_t*));
+
+    return 0;
+}
+
+s32_t tt_init_mem(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr, void* mem, u32_t size)
+{
+    u32_t rsz = 1;
+
+    tt_memset((void*) tt, 0, sizeof(tt_t));
+
+    if (init_check(nwnd, mtu) < 0) return TT_ERRMEM;
+
+    while (rsz < 2u * mtu) rsz <<= 1;
+
+    if (!mem || size < TT_MEMSZ(nwnd, mtu, rsz)) {
+        tt_println("window memory too small (%u < %u)", size, TT_MEMSZ(nwnd, mtu, rsz));
+        return TT_ERRMEM;
+    }
+
+    /* 剩余的内存用于加大接收环 */
+    while (rsz < 0x40000000 && TT_MEMSZ(nwnd, mtu, rsz * 2) <= size) rsz <<= 1;
+
+    init_mem(tt, rcb, wcb, nwnd, mtu, mackr, usr, (u8_t*) mem, rsz);
+    tt->umem = 1;
+
+    return 0;
+}
+
+/* 归还接收缓存借用的全部单元 */
+static void buf_put_all(tt_t* tt)
+{
+    u32_t i;
+
+    for (i = 0; tt->bptr && i < tt->nwnd; ++i) {
+        buf_put(tt, i);
+    }
+}
+
+void tt_deinit(tt_t* tt)
+{
+    buf_put_all(tt);
+
+    if (tt->bptr) {
+        tt_free(tt->bptr);
+    } else if (tt->ts && !tt->umem) {
+        tt_free(tt->ts);
+    }
+
+    if (tt->biov) {
+        tt_free(tt->biov);
+    }
+
+    if (tt->fgrp) {
+        tt_free(tt->fgrp);
+    }
+
+    if (tt->lzh) {
+        tt_free(tt->lzh);
+    }
+
+    tt->biov = 0;
+    tt->bhdr = 0;
+    tt->nbat = 0;
+    tt->nbq = 0;
+
+    tt->ts = 0;
+    tt->umem = 0;
+    tt->map = 0;
+    tt->soff = 0;
+    tt->slen = 0;
+    tt->blen = 0;
+    tt->boff = 0;
+    tt->rxb = 0;
+    tt->txb = 0;
+    tt->buf = 0;
+    tt->bptr = 0;
+    tt->pool = 0;
+
+    tt->fgrp = 0;
+    tt->bseq = 0;
+    tt->bpl = 0;
+    tt->fenc = 0;
+    tt->facc = 0;
+    tt->fk = 0;
+    tt->fm = 0;
+
+    tt->lzh = 0;
+}
+
+void tt_set_probe(tt_t* tt, u8_t on)
+{
+    tt->probe = on;
+    tt->spl = on && TT_DPL(tt) > TT_SZPL ? TT_SZPL : TT_DPL(tt);
+    tt->pbad = 0;
+    tt->ppl = 0;
+    tt->pnum = 0;
+    tt->ngood = 0;
+}
+
+/* 设置包头可选字段，包头长度与负载长度随之调整 */
+static s32_t hdr_opt(tt_t* tt, u8_t opt, u8_t on)
+{
+    u8_t ftag = on ? tt->ftag | opt : tt->ftag & ~opt;
+    u8_t hsz = TT_SZHDR + (ftag & TT_FCID ? 2 : 0) + (ftag & TT_FWND ? 2 : 0);
+
+    if (tt->mtu <= hsz) {
+        tt_println("mtu %d too small for header %d", tt->mtu, hsz);
+        return TT_ERRMEM;
+    }
+
+    tt->ftag = ftag;
+    tt->hsz = hsz;
+    tt_set_probe(tt, tt->probe);
+
+    return 0;
+}
+
+s32_t tt_set_cid(tt_t* tt, u16_t cid)
+{
+    if (hdr_opt(tt, TT_FCID, 1) < 0) return TT_ERRMEM;
+
+    tt->cid = cid;
+
+    return 0;
+}
+
+s32_t tt_set_rwnd(tt_t* tt, u8_t on)
+{
+    if (hdr_opt(tt, TT_FWND, on) < 0) return TT_ERRMEM;
+
+    /* 收到对方的通告之前假定对方窗口与本端一致 */
+    tt->rwr = tt->seq + tt->nwnd;
+    tt->awr = tt->ack + tt->nwnd;
+
+    return 0;
+}
+
+s32_t tt_set_fec(tt_t* tt, u8_t k, u8_t m)
+{
+    u16_t ngrp = 0;
+    u32_t sz = 0;
+    u8_t* mem = 0;
+
+    if (k > TT_FECK || m > TT_FECM) {
+        tt_println("invalid FEC %d/%d", k, m);
+        return TT_ERRMEM;
+    }
+
+    if (!k || !m) k = m = 0;
+    if (k > tt->nwnd) k = (u8_t) tt->nwnd;
+
+    /* 分组、接收缓存各单元的序号与长度、编码区、各组的校验行一次分配 */
+    if (k) {
+        ngrp = tt->nwnd / k + 2;
+        sz = ngrp * sizeof(tt_fgrp) + tt->nwnd * (sizeof(u32_t) + sizeof(u16_t)) + (1 + ngrp) * m * TT_FSZ(tt);
+        mem = tt_malloc(sz);
+        if (!mem) {
+            tt_println("malloc FEC failed");
+            return TT_ERRMEM;
+        }
+        tt_memset(mem, 0, sz);
+    }
+
+    if (tt->fgrp) {
+        tt_free(tt->fgrp);
+    }
+
+    tt->fgrp = (tt_fgrp*) mem;
+    tt->bseq = mem ? (u32_t*) (tt->fgrp + ngrp) : 0;
+    tt->bpl = mem ? (u16_t*) (tt->bseq + tt->nwnd) : 0;
+    tt->fenc = mem ? (u8_t*) (tt->bpl + tt->nwnd) : 0;
+    tt->facc = mem ? tt->fenc + m * TT_FSZ(tt) : 0;
+    tt->ngrp = ngrp;
+    tt->fk = k;
+    tt->fm = m;
+    tt->fcnt = 0;
+    tt->fpend = 0;
+    tt->fmax = 0;
+
+    /* 数据包负载上限随之变化 */
+    tt_set_probe(tt, tt->probe);
+
+    return 0;
+}
+
+s32_t tt_set_lz(tt_t* tt, u8_t on)
+{
+    if (on && !tt->lzh) {
+        tt->lzh = tt_malloc(TT_LZ_HSZ * sizeof(u16_t));
+        if (!tt->lzh) {
+            tt_println("malloc LZ table failed");
+            return TT_ERRMEM;
+        }
+        tt_memset((void*) tt->lzh, 0, TT_LZ_HSZ * sizeof(u16_t));
+
+    } else if (!on && tt->lzh) {
+        tt_free(tt->lzh);
+        tt->lzh = 0;
+    }
+
+    tt->zskip = 0;
+    tt->zmiss = 0;
+
+    return 0;
+}
+
+void tt_set_crc(tt_t* tt, tt_crcfn fn)
+{
+    tt->crcf = fn;
+}
+
+void tt_set_clock(tt_t* tt, tt_clk clk)
+{
+    tt->clk = clk;
+}
+
+void tt_set_cc(tt_t* tt, const tt_cc* cc)
+{
+    tt->cc = cc;
+    tt->crcv = 0;
+    tt->cacc = 0;
+
+    if (cc) cc->init(tt);
+}
+
+void tt_set_dupk(tt_t* tt, u16_t k)
+{
+    tt->dupk = k;
+}
+
+void tt_set_early(tt_t* tt, u8_t on)
+{
+    tt->early = on;
+}
+
+void tt_set_ack(tt_t* tt, u16_t n, u16_t delay)
+{
+    tt->ackn = n;
+    tt->ackd = delay;
+}
+
+void tt_set_iocb(tt_t* tt, tt_iocb iocb)
+{
+    /* 排队的包用原回调写出，恢复使用wcb时关闭批量发送 */
+    if (tt->iocb) frame_flush(tt);
+
+    tt->iocb = iocb;
+
+    if (!iocb && tt->nbat) tt_set_batch(tt, 0);
+}
+
+s32_t tt_set_batch(tt_t* tt, u16_t nbat)
+{
+    u8_t* mem = 0;
+
+    /* 批量发送只对分散写回调有效，wcb逐包写出 */
+    if (nbat > 0 && !tt->iocb) {
+        tt_println("batch needs iocb");
+        return TT_ERRMEM;
+    }
+
+    if (nbat > tt->nwnd) nbat = tt->nwnd;
+
+    /* iov列表与包头缓存一次分配 */
+    if (nbat > 0) {
+        mem = tt_malloc(nbat * (3 * sizeof(tt_iov) + TT_SZHDRX));
+        if (!mem) {
+            tt_println("malloc batch failed");
+            return TT_ERRMEM;
+        }
+    }
+
+    if (tt->biov) {
+        tt_free(tt->biov);
+    }
+
+    tt->biov = (tt_iov*) mem;
+    tt->bhdr = mem ? mem + nbat * 3 * sizeof(tt_iov) : 0;
+    tt->nbat = nbat;
+    tt->nbq = 0;
+
+    return 0;
+}
+
+void tt_reset(tt_t* tt)
+{
+    u32_t i;
+
+    tt->seq = 0;
+    tt->ack = 0;
+    tt->wnd = 0;
+    tt->closed = 0;
+    tt->rhd = 0;
+    tt->rtl = 0;
+    tt->rwait = 0;
+
+    tt->nseg = 0;
+    tt->stot = 0;
+    tt->una = 0;
+    tt->nxt = 0;
+    tt->nsnt = 0;
+    tt->nlst = 0;
+    tt->lcur = 0;
+    tt->sw = 0;
+    tt->nsend = 0;
+    tt->pend = 0;
+    tt->pprb = 0;
+    tt->fin = 0;
+    tt->nrun = 0;
+    tt->nrcv = 0;
+    tt->nack = 0;
+    tt->rwr = tt->nwnd;
+    tt->wnum = 0;
+    tt->awr = tt->nwnd;
+    tt->fcnt = 0;
+    tt->fpend = 0;
+    tt->zskip = 0;
+    tt->zmiss = 0;
+    tt->zann = 0;
+    tt->caps = 0;
+
+    tt_set_cc(tt, tt->cc);
+
+    tt_memset((void*) tt->blen, 0, tt->nwnd * sizeof(u16_t));
+    tt_memset((void*) tt->map, 0, 3 * TT_NWORD(tt->nwnd) * sizeof(u32_t));
+    buf_put_all(tt);
+
+    for (i = 0; i < tt->ngrp; ++i) {
+        tt->fgrp[i].n = 0;
+    }
+}
+
+/* 重置发送状态，开始发送buf */
+static void snd_reset(tt_t* tt, const u8_t* buf, u32_t len)
+{
+    tt_memset((void*) tt->map, 0, 3 * TT_NWORD(tt->nwnd) * sizeof(u32_t));
+
+    tt->sbuf[0] = buf;
+    tt->sbeg[0] = 0;
+    tt->nseg = 1;
+    tt->stot = len;
+    tt->una = 0;
+    tt->nxt = 0;
+    tt->nsnt = 0;
+    tt->nlst = 0;
+    tt->lcur = 0;
+    tt->sw = 0;
+    tt->nsend = 0;
+}
+
+/* tt_send重新传入上次未发送完的数据（buf对应上次的una处）：已发出未确认的包保留原来的划分、位图与时间戳，
+ * 只把偏移移到新的buf上。这些包对方可能已经SACK，负载减半后若按新的spl重新划分，同一序号会对应不同的数据
+ */
+static void snd_resume(tt_t* tt, const u8_t* buf, u32_t len)
+{
+    u32_t base = tt->una;
+    u32_t i;
+
+    if (tt->nseg != 1 || !tt->nsnt || tt->nxt - base > len) {
+        snd_reset(tt, buf, len);
+        return;
+    }
+
+    for (i = 0; i < tt->nsnt; ++i) tt->soff[TT_RING(tt, tt->sw, i)] -= base;
+
+    tt->sbuf[0] = buf;
+    tt->stot = len;
+    tt->una = 0;
+    tt->nxt -= base;
+    tt->nsend = 0;
+}
+
+s32_t tt_submit(tt_t* tt, const u8_t* buf, u32_t len)
+{
+    if (tt->closed) {
+        tt_println("connection is closed");
+        return TT_ERRFINAL;
+    }
+
+    if (tt->una == tt->stot) {
+        snd_reset(tt, buf, len);
         return 0;
     }
 
-    while (mrecv-- > 0) {
-        rt = tt->rcb(tt->usr, tmp + sz, TT_SZPKT - sz);
+    /* 上次的数据未全部确认，追加为新的数据段 */
+    if (tt->nseg >= TT_NSEG || len > 0xffffffffu - tt->stot) {
+        tt_println("too many segments not acked");
+        return TT_ERRBUSY;
+    }
+
+    if (len) {
+        tt->sbuf[tt->nseg] = buf;
+        tt->sbeg[tt->nseg] = tt->stot;
+        ++tt->nseg;
+        tt->stot += len;
+    }
+
+    return 0;
+}
+
+s32_t tt_input(tt_t* tt, const u8_t* data, u32_t len)
+{
+    u32_t done = 0;
+    u32_t off;
+    u32_t n;
+
+    while (done < len) {
+        off = tt->rtl & (tt->rsz - 1);
+        n = tt->rsz - (tt->rtl - tt->rhd);
+
+        if (n > tt->rsz - off) n = tt->rsz - off;
+        if (n > len - done) n = len - done;
+        if (!n) break;
+
+        tt_memcpy(tt->rxb + off, data + done, n);
+        tt->rtl += n;
+        done += n;
+
+        /* 每次写入后取出完整的包，环中最多剩下不足一个包的数据 */
+        frame_input(tt);
+    }
+
+    return done;
+}
+
+s32_t tt_poll_output(tt_t* tt, u8_t* buf, u32_t len)
+{
+    const u8_t* pld;
+    u16_t n;
+    u16_t pl;
+    u16_t crc;
+
+    if (len < tt->mtu) {
+        tt_println("output buffer too small");
+        return TT_ERRMEM;
+    }
+
+    n = out_next(tt, buf, &pld);
+
+    /* 数据包补全负载与CRC */
+    if (n && pld) {
+        pl = n - tt->hsz;
+        TT_SET_PLD(tt, buf, pl, pld);
+
+        crc = crc16(tt, buf, pl + tt->hsz - 2);
+        TT_SET_CRC(tt, buf, pl, crc);
+    }
+
+    return n;
+}
+
+void tt_tick(tt_t* tt, u32_t now)
+{
+    tt->now = now;
+    tt->tick = 1;
+
+    /* 不完整的包在同一位置等待超过一个RTO（不含退避），重新同步并处理其后已收到的包 */
+    if (tt->rwait && tt->rwp == tt->rhd && TT_SEQ_DIFF(now, tt->rts) >= (s32_t) rto_base(tt)) {
+        frame_stall(tt);
+        frame_input(tt);
+    }
+
+    snd_timer(tt, 0);
+}
+
+/* 以到期时间due更新最近的定时（已到期为0） */
+static void tmr_min(tt_t* tt, s32_t* t, u32_t due)
+{
+    s32_t d = TT_SEQ_DIFF(due, tt->now);
+
+    if (d < 0) d = 0;
+    if (*t < 0 || d < *t) *t = d;
+}
+
+s32_t tt_timeout(tt_t* tt)
+{
+    s32_t t = -1;
+
+    if (tt->nsnt) {
+        tmr_min(tt, &t, tt->ts[tt->sw] + tt->rto);
+    }
+
+    if (tt->ppl) {
+        tmr_min(tt, &t, tt->pts + tt->rto);
+    }
+
+    if (tt->fin && !tt->closed) {
+        tmr_min(tt, &t, tt->fts + tt->rto);
+    }
+
+    /* 不完整的包停滞 */
+    if (tt->rwait && tt->rwp == tt->rhd) {
+        tmr_min(tt, &t, tt->rts + rto_base(tt));
+    }
+
+    /* 延迟ACK */
+    if (tt->nack && tt->ackd && !(tt->pend & TT_PACK)) {
+        tmr_min(tt, &t, tt->ats + tt->ackd);
+    }
+
+    /* 窗口探测 */
+    if (!tt->nsnt && tt->nxt < tt->stot && !TT_WOPEN(tt)) {
+        tmr_min(tt, &t, tt->wts + TT_WIVL(tt));
+    }
+
+    return t;
+}
+
+s32_t tt_read(tt_t* tt, u8_t* buf, s32_t len)
+{
+    return deliver(tt, buf, len);
+}
+
+void tt_shutdown(tt_t* tt)
+{
+    if (tt->closed || tt->fin) return;
+
+    /* 未确认的数据不再重发 */
+    tt->nsnt = 0;
+    tt->nlst = 0;
+    tt->stot = tt->nxt = tt->una;
+
+    tt->fin = 1;
+    tt->fts = tt->now;
+    tt->pend |= TT_PFIN;
+}
+
+s32_t tt_send(tt_t* tt, const u8_t* buf, s32_t len, s32_t msend)
+{
+    s32_t rt;
+    u32_t seq;
+    s32_t nrecv = 0; /* 当前连续接收超时次数 */
+
+    tt_println("tt_send len %d", len);
+
+    if (tt->closed) {
+        tt_println("connection is closed");
+        return TT_ERRFINAL;
+    }
+
+    /* 上次未发送完的数据由调用者重新传入，已发出的包按原来的划分继续重发 */
+    snd_resume(tt, buf, len);
+
+    while (tt->una < (u32_t) len) {
+
+        if (tt->clk) tt->now = tt->clk(tt->usr);
+
+        /* 发送待重发的包和新进入窗口的包 */
+        if (out_flush(tt) < 0) {
+            tt_println("writecb (data) failed, return");
+            return TT_ERRSEND;
+        }
+
+        /* 接收ACK */
+        rt = frame_read(tt);
         if (rt < 0) {
-            tt_println("readcb (FIN) failed, return");
+            tt_println("readcb (ACK) failed");
             return TT_ERRRECV;
         }
 
-        if (!rt) continue;
+        if (!rt) {
+            ++nrecv;
+            tt_println("readcb (ACK) timeout");
+        }
 
-        /* 先校验第一个字节是否正确，下面再进一步校验 */
-        if ((TT_GET_FLG(tmp) & TT_FMASK) != TT_FTAG) {
-            tt_println("got an error packet (flag) first");
-            continue;
+        if (tt->clk) tt->now = tt->clk(tt->usr);
+
+        /* 处理接收环中的包（可能有多个），窗口右移则超时计数清零 */
+        seq = tt->seq;
+        frame_input(tt);
+        if (tt->seq != seq) nrecv = 0;
+
+        if (tt->closed) {
+            tt_println("connection closed by peer");
+            break;
         }
 
-        sz += rt;
-        /* 接收长度不足一个包 */
-        if (sz < TT_SZHDR) {
-            tt_println("packet need more (header)");
-            continue;
+        /* 设置了时钟时按RTO判断超时，否则按连续读超时次数判断 */
+        if (tt->clk) {
+            snd_timer(tt, 0);
+        } else if (nrecv >= tt->mackr) {
+            snd_timer(tt, 1);
+            nrecv = 0;
         }
 
-        pkt = tmp;
-        /* 处理包 */
-        do {
-            /* 收到了错误的包（flag错误），丢弃 */
-            if ((TT_GET_FLG(pkt) & TT_FMASK) != TT_FTAG) {
-                tt_println("got an error packet (flag)");
-                sz = 0; break;
-            }
+        if (tt->nsend >= msend) {
+            tt_println("resend count reach max, break");
+            break;
+        }
+    }
 
-            pl = TT_GET_LEN(pkt);
-            /* 收到了错误的包（负载过长），丢弃 */
-            if (pl > TT_SZPL) {
-                tt_println("got an error packet (payload)");
-                sz = 0; break;
-            }
+    /* 对方关闭时回复FIN */
+    if (tt->pend && out_flush(tt) < 0) {
+        tt_println("writecb (FIN) failed");
+        return TT_ERRSEND;
+    }
+
+    return tt->una;
+}
+
+s32_t tt_recv(tt_t* tt, u8_t* buf, s32_t len, s32_t mrecv)
+{
+    s32_t rt;
+    s32_t rcv = 0;  /* 已往buf写入的字节数 */
+    s32_t nrecv = 0; /* 当前接收次数 */
+
+    tt_println("tt_recv expect len %d", len);
+
+    /* 若接收缓冲区有数据，则先拷贝到用户区 */
+    rcv = deliver_flush(tt, buf, len);
+
+    /* 用户缓冲已满，直接返回 */
+    if (rcv == len) return rcv;
+
+    if (tt->closed) {
+        tt_println("connection is closed");
+        return rcv > 0 ? rcv : TT_ERRFINAL;
+    }
 
-            /* 该包还未收完，保留 */
-            if (sz < TT_SZHDR + pl) {
-                tt_println("packet need more (payload)");
+    while (1) {
+        rt = recv_data(tt);
+        if (rt < 0) {
+            tt_println("recv data failed (%d), return", rt);
+            return rt;
+        }
+
+        if (!rt) {
+            /* 如果已经接收到了数据，超时一次就返回 */
+            if (rcv > 0) {
+                tt_println("readcb (data) timeout but recved > 0, break");
                 break;
             }
-
-            crc = crc16(pkt, pl + TT_SZHDR - 2);
-            /* CRC校验失败，丢弃 */
-            if (TT_GET_CRC(pkt, pl) != crc) {
-                tt_println("got an error packet (crc)");
-                sz = 0; break;
+            if (++nrecv >= mrecv) {
+                tt_println("readcb (data) timeout count reach max, break");
+                break;
             }
+            tt_println("readcb (data) timeout");
+            continue;
+        }
 
-            if (TT_GET_FLG(pkt) & TT_FIN) {
-                /* 收到了FIN，响应FIN */
-                tt_println("FIN recved, reply FIN");
+        /* 将接收缓存区（tt->buf）的数据拷贝到用户区（buf） */
+        rt = deliver_flush(tt, buf + rcv, len - rcv);
+        if (rt > 0) {
+            rcv += rt;
+            /* 重试次数清零 */
+            nrecv = 0;
+        }
 
-                TT_SET_SEQ(pkt, tt->seq);
-                TT_SET_ACK(pkt, tt->ack);
-                TT_SET_LEN(pkt, 0);
+        if (tt->closed) {
+            tt_println("connection closed by peer");
+            break;
+        }
 
-                crc = crc16(pkt, TT_SZHDR - 2);
-                TT_SET_CRC(pkt, 0, crc);
+        /* 用户缓冲已满，不再继续接收 */
+        if (rcv == len) break;
+    }
 
-                /* 发送FIN包，告知tt->ack之前的包已全部接收到 */
-                if (tt->wcb(tt->usr, pkt, TT_SZHDR) < 0) {
-                    tt_println("writecb (FIN) failed");
-                    return TT_ERRSEND;
-                }
+    tt_println("tt_recv actual len %d", rcv);
+    return rcv;
+}
 
-            } else if (TT_GET_FLG(pkt) & TT_ACK) {
-                /* 收到了ACK，丢弃 */
-                tt_println("ACK recved, drop it");
-            } else {
-                /* 收到了数据包，跳出循环 */
-                tt_println("data packet recved, return");
-                return 0;
+s32_t tt_recv_zc(tt_t* tt, tt_iov* iov, s32_t niov, s32_t mrecv)
+{
+    s32_t rt;
+    s32_t nrecv = 0;
+    s32_t n;
+    u16_t i;
+
+    /* 接收直到窗口左边沿有数据 */
+    while (!tt->blen[tt->wnd]) {
+        if (tt->closed) {
+            tt_println("connection is closed");
+            return TT_ERRFINAL;
+        }
+
+        rt = recv_data(tt);
+        if (rt < 0) {
+            tt_println("recv data failed (%d), return", rt);
+            return rt;
+        }
+
+        if (!rt && ++nrecv >= mrecv) {
+            tt_println("readcb (data) timeout count reach max, break");
+            return 0;
+        }
+    }
+
+    /* 按序数据原地借给用户 */
+    for (n = 0, i = tt->wnd; n < niov && tt->blen[i]; ++n, i = TT_RING(tt, i, 1)) {
+        iov[n].buf = TT_BUF(tt, i) + tt->boff[i];
+        iov[n].len = tt->blen[i];
+    }
+
+    return n;
+}
+
+void tt_release(tt_t* tt, s32_t len)
+{
+    tt_println("release %d bytes", len);
+    deliver_flush(tt, 0, len);
+}
+
+s32_t tt_close(tt_t* tt, s32_t msend)
+{
+    s32_t rt;
+    s32_t nrecv = 0;
+    s32_t nfin = 0;     /* 已发送FIN的次数 */
+
+    if (tt->closed) {
+        tt_println("connection is already closed");
+        return 0;
+    }
+
+    if (tt->clk) tt->now = tt->clk(tt->usr);
+
+    tt_shutdown(tt);
+
+    while (1) {
+        /* 发送FIN包，告知tt->ack之前的包已全部接收到 */
+        if (tt->pend & TT_PFIN) {
+            if (nfin++ >= msend) {
+                tt_println("FIN resend count reach max, break");
+                break;
             }
+            nrecv = 0;
+        }
+
+        if (out_flush(tt) < 0) {
+            tt_println("writecb (FIN) failed");
+            return TT_ERRSEND;
+        }
+
+        /* 接收对方返回的FIN包 */
+        rt = frame_read(tt);
+        if (rt < 0) {
+            tt_println("readcb (FIN) failed, return");
+            return TT_ERRRECV;
+        }
+
+        if (!rt) {
+            ++nrecv;
+            tt_println("readcb (FIN) timeout");
+        }
+
+        if (tt->clk) tt->now = tt->clk(tt->usr);
+
+        frame_input(tt);
+
+        if (tt->closed) {
+            tt_println("FIN recved, return");
+            return 0;
+        }
+
+        /* FIN超时未回复则重发 */
+        if (tt->clk) {
+            snd_timer(tt, 0);
+        } else if (nrecv >= tt->mackr) {
+            snd_timer(tt, 1);
+        }
+    }
+
+    return 0;
+}
+
+s32_t tt_wait(tt_t* tt, s32_t mrecv)
+{
+    s32_t rt;
 
-            pkt += TT_SZHDR + pl;
-            sz -= TT_SZHDR + pl;
+    if (!tt->closed) {
+        tt_println("connection is not closed, return");
+        return 0;
+    }
+
+    while (mrecv-- > 0) {
+        rt = frame_read(tt);
+        if (rt < 0) {
+            tt_println("readcb (FIN) failed, return");
+            return TT_ERRRECV;
+        }
+
+        if (!rt) continue;
+
+        /* 收到了FIN则响应FIN（已主动关闭的一方不响应），收到了ACK则丢弃 */
+        rt = frame_input(tt);
+
+        if (out_flush(tt) < 0) {
+            tt_println("writecb (FIN) failed");
+            return TT_ERRSEND;
         }
-        while (sz > 0);
 
-        if (sz > 0 && pkt != tmp) {
-            tt_println("recv buf left");
-            tt_memmove(tmp, pkt, sz);
+        /* 收到了数据包，跳出循环 */
+        if (rt > 0) {
+            tt_println("data packet recved, return");
+            return 0;
         }
     }
 
@@ -15,16 +15,81 @@ flag
 | version | reserved | FIN | ACK |
 |   4b    |    2b    | 1b  | 1b  |
 ----------------------------------
+version为0b1100时为上述包头；version的低2位表示len之后的可选字段（CRC同样覆盖），收发双方需一致：
+0b1101（版本2）带2字节的连接ID（cid），0b1110带2字节的接收窗口（wnd），0b1111两者都有（cid在前）：
+------------------------------------------------------
+| flag | seq | ack | len | cid | wnd | payload | crc |
+|  1B  |  2B |  2B |  2B |  2B |  2B |  <len>  |  2B |
+------------------------------------------------------
+seq/ack只传低16位，收到后按与本端序号最接近的原则扩展为32位，回绕后无需重置连接。
+ACK包：ack为累计确认（该序号之前的包已全部收到），payload为其后的乱序包位图，
+第k位（第k/8字节的第k%8位）为1表示序号 ack + 1 + k 的包已收到。
+数据包：ack为捎带的累计确认。双方同时发送数据（全双工）时，没有乱序包需要报告的ACK随数据包捎带，
+不再单独发送ACK包。
+探测包：FIN与ACK同时置位，payload为填充数据（不属于数据流），对方收到后回复
+FIN|ACK且len为0、ack为探测包负载长度的应答包。len与ack都为0时为窗口探测，对方回复ACK。
+len为0且ack最高位（TT_CAPS）为1时为能力通告，ack低位为本端支持的功能（TT_CLZ：能解压压缩数据包），
+不需要回复；不认识该包的旧版本按不匹配的探测应答忽略。
+wnd：本端在累计确认之后还能接收的包个数，对方发送的新包不超过 ack + wnd。
+保留位为0b11；压缩数据包（tt_set_lz）保留位为0b10，payload为按tt_lz.h格式压缩的负载，len为压缩后的长度，
+只在收到对方的TT_CLZ能力通告后发送。
+FEC校验包（tt_set_fec）：保留位为0b01，seq为组首包序号，ack高8位为组内包个数n、低8位为校验行号j，
+payload为第j行：组内各包（2字节负载长度 + 负载，补0到最长）按系数coef(j, i)的线性组合（见tt_fec.h），
+len为组内最长负载 + 2。开启FEC后数据包负载上限相应减2。
 */
 
-#define TT_SZWND        8       /* 窗口大小，最大32 */
-#define TT_SZPKT        185     /* MTU，最大32767（0x7fff） */
+#define TT_SZWND        8       /* 默认窗口大小 */
+#define TT_MAXWND       4096    /* 窗口大小上限（须远小于16位序号空间的一半） */
+#define TT_SZPKT        185     /* 默认MTU，最大32767（0x7fff） */
 #define TT_SZHDR        9       /* 包头长度（包含2字节的CRC） */
-#define TT_SZPL         (TT_SZPKT - TT_SZHDR)   /* 单包最大负载长度 */
+#define TT_SZHDR2       11      /* 版本2包头长度（包含2字节的连接ID与2字节的CRC） */
+#define TT_SZHDRX       13      /* 最长包头（连接ID与接收窗口都有） */
+
+#define TT_FMASK        0b11111100  /* flag中的版本与保留位 */
+#define TT_FTAG         0b11001100  /* 版本1 */
+#define TT_FCID         0b00010000  /* 可选字段：连接ID */
+#define TT_FWND         0b00100000  /* 可选字段：接收窗口 */
+#define TT_FTAG2        (TT_FTAG | TT_FCID)     /* 版本2（包头带连接ID） */
+#define TT_FFEC         0b00001000  /* 保留位的高位清零表示FEC校验包 */
+#define TT_FLZ          0b00000100  /* 保留位的低位清零表示负载已压缩 */
+#define TT_CAPS         0x8000      /* 能力通告（零负载探测包的ack字段最高位） */
+#define TT_CLZ          0x0001      /* 能力：能解压压缩数据包 */
+#define TT_SZPL         (TT_SZPKT - TT_SZHDR)   /* 默认MTU下单包最大负载长度，也是探测的起始负载长度 */
+#define TT_PRBCNT       16      /* 探测模式下连续确认多少个包后尝试增大负载 */
+#define TT_PRBMAX       3       /* 同一长度的探测包连续失败多少次后认为该长度不可用 */
+#define TT_DUPK         3       /* 默认快速重传阈值 */
+
+#ifndef TT_SZRXB
+#if TT_USE_STD_FUNC
+#define TT_SZRXB        65536   /* 接收环大小，实际取不小于该值及2*mtu的2的幂 */
+#else
+#define TT_SZRXB        0       /* 嵌入式平台默认只分配2*mtu（向上取2的幂） */
+#endif
+#endif
+
+#ifndef TT_NSEG
+#define TT_NSEG         8       /* tt_submit在上次提交的数据确认之前最多可追加的数据段个数 */
+#endif
+
+#ifndef TT_SZRXP
+#define TT_SZRXP        0       /* tt_init_pool的接收环大小，默认只取2*mtu（向上取2的幂），连接多时不按TT_SZRXB分配 */
+#endif
+
+/* 窗口缓存大小（tt_init_mem）：ts、soff各nwnd个u32_t，位图3*(nwnd+31)/32个u32_t，slen/blen/boff各nwnd个u16_t，
+ * 接收环rsz字节（2的幂，不小于2*mtu）及mtu字节预留区，发送帧缓存mtu字节，接收缓存nwnd*(mtu-TT_SZHDR)字节
+ */
+#define TT_MEMSZ(nwnd, mtu, rsz)    ((u32_t) (nwnd) * 14 + 12u * (((nwnd) + 31) >> 5) \
+                                     + (rsz) + 2u * (mtu) + (u32_t) (nwnd) * ((mtu) - TT_SZHDR))
+
+#define TT_RTOINIT      1000    /* 未测得RTT时的初始重传超时（毫秒） */
+#define TT_RTOMIN       2       /* 重传超时下限（毫秒） */
+#define TT_RTOMAX       60000   /* 重传超时上限（毫秒），指数退避不超过此值 */
 
 #define TT_ERRRECV      -1
 #define TT_ERRSEND      -2
 #define TT_ERRFINAL     -3
+#define TT_ERRMEM       -4
+#define TT_ERRBUSY      -5
 
 typedef unsigned char   u8_t;
 typedef char            s8_t;
@@ -33,43 +98,325 @@ typedef short           s16_t;
 typedef unsigned int    u32_t;
 typedef int             s32_t;
 
-/* 回调该函数时len最大值为TT_SZPKT */
+/* 写出时len最大值为tt->mtu；读取时len为接收环的连续空闲长度（不超过32767），可一次返回多个包 */
 typedef s16_t (*tt_cb)(void* usr, u8_t* buf, s16_t len);
 
+/* 数据块（指针+长度） */
 typedef struct {
-    u16_t   seq;
-    u16_t   ack;
+    const u8_t* buf;
+    u32_t       len;
+} tt_iov;
+
+/* 分散写回调，将cnt个数据块按顺序作为连续的字节流写出，返回写出的字节数（小于0表示出错） */
+typedef s32_t (*tt_iocb)(void* usr, const tt_iov* iov, s32_t cnt);
+
+/* 校验函数，计算CRC16-CCITT（多项式0x1021，初值0），crc为上一段的结果（分段计算，见tt_crc.h） */
+typedef u16_t (*tt_crcfn)(u16_t crc, const u8_t* data, u32_t len);
+
+/* 单调时钟，返回毫秒数（允许回绕） */
+typedef u32_t (*tt_clk)(void* usr);
+
+typedef struct tt_s tt_t;
+
+/* 接收缓存池，定义见tt_pool.h */
+typedef struct tt_pool_s tt_pool;
+
+/* FEC接收分组：组内有缺失时保存收到的校验行，缺失的包数不超过校验行数时解出 */
+typedef struct {
+    u32_t   seq;    /* 组首包序号 */
+    u16_t   len;    /* 校验包负载长度 */
+    u8_t    n;      /* 组内数据包个数（0表示空闲） */
+    u8_t    rows;   /* 已收到的校验行（第j位为第j行） */
+} tt_fgrp;
+
+/* 拥塞控制算法，通过tt->cwnd（包个数）限制已发送未确认的包，状态可使用tt->cwnd/ssth/cacc，实现见tt_cc.h */
+typedef struct {
+    const char* name;
+    void (*init)(tt_t* tt);                         /* 初始化（tt_set_cc、tt_reset时调用） */
+    void (*ack)(tt_t* tt, u32_t n, u32_t rtt);      /* n个包新被确认，rtt为本次采样（毫秒，0表示无采样） */
+    void (*loss)(tt_t* tt, u8_t timeout);           /* 检测到丢包（快速重传，每次恢复只报告一次）或超时 */
+} tt_cc;
+
+struct tt_s {
+    u32_t   seq;    /* 发送序号（扩展为32位，线上只传低16位） */
+    u32_t   ack;    /* 接收序号（扩展为32位，线上只传低16位） */
     tt_cb   rcb;
     tt_cb   wcb;
+    tt_iocb iocb;   /* 分散写回调，设置后代替wcb */
+    tt_iov* biov;   /* 批量发送的iov列表，每包3个 */
+    u8_t*   bhdr;   /* 批量发送的包头缓存，每包TT_SZHDR字节 */
+    u16_t   nbat;   /* 单次批量写出的最大包数（0表示不批量） */
+    u16_t   nbq;    /* 已排队的包数 */
 
-    u8_t    buf[TT_SZWND][TT_SZPL]; /* 接收缓存 */
-    u16_t   blen[TT_SZWND];         /* buf数组对应数据长度 */
-    u8_t    wnd;                    /* 窗口位置偏移 */
+    u16_t   nwnd;                   /* 窗口大小 */
+    u16_t   mtu;                    /* 最大包长（含包头） */
+    u8_t*   buf;                    /* 接收缓存，nwnd个单元，每单元mtu - TT_SZHDR字节（使用缓存池时为0） */
+    tt_pool* pool;                  /* 接收缓存池（tt_init_pool） */
+    u8_t**  bptr;                   /* 使用缓存池时各单元借到的空间（0表示未借用） */
+    u16_t*  blen;                   /* buf各单元对应数据长度（用户未取走的部分） */
+    u16_t*  boff;                   /* buf各单元中用户未取走数据的起始偏移 */
+    u16_t   wnd;                    /* 窗口位置偏移（tt->ack对应的buf单元） */
     u8_t    closed;                 /* 是否已接收/发送完毕 */
+    u8_t    umem;                   /* 窗口缓存由调用者提供（tt_init_mem），tt_deinit时不释放 */
+    tt_crcfn crcf;                  /* 帧校验函数（0表示tt_crc16） */
 
-    u16_t   mackr;   /* 接收ACK的最大次数，超过此值后会进入重发流程 */
+    u32_t*  ts;                     /* 发送窗口各包最近一次的发送时间 */
+    u32_t*  map;                    /* 发送窗口位图（已确认、重发过、待重发），各(nwnd+31)/32个字 */
+    u32_t*  soff;                   /* 发送窗口各包在用户数据中的偏移 */
+    u16_t*  slen;                   /* 发送窗口各包的负载长度 */
+    const u8_t* sbuf[TT_NSEG];      /* 待发送的用户数据（不拷贝），第k段从sbeg[k]开始，到下一段（最后一段到stot）为止 */
+    u32_t   sbeg[TT_NSEG];
+    u8_t    nseg;                   /* 数据段个数（已全部确认的段移出） */
+    u32_t   stot;                   /* 待发送的总字节数 */
+    u32_t   una;                    /* 已确认的字节数 */
+    u32_t   nxt;                    /* 下一个新包在待发送数据中的偏移 */
+    u32_t   nsnt;                   /* 窗口内已发送的包个数（总是从左边沿开始连续） */
+    u32_t   nlst;                   /* 需要重发的包个数 */
+    u32_t   lcur;                   /* 查找需要重发的包的起始位置（相对左边沿） */
+    u16_t   sw;                     /* 发送窗口左边沿对应的下标 */
+    u16_t   nsend;                  /* 连续超时重发次数，收到有效包后清零 */
+    u8_t    pend;                   /* 待发送的控制包（ACK、FIN） */
+    u8_t    fin;                    /* 已主动发送FIN，等待对方回复 */
+    u16_t   pprb;                   /* 待回复的探测包负载长度（0表示无） */
+    u32_t   fts;                    /* 主动FIN的发送时间 */
+    u8_t*   rxb;                    /* 接收环，rsz字节，其后mtu字节用于拼接跨越环尾的包 */
+    u32_t   rsz;                    /* 接收环大小（2的幂） */
+    u32_t   rhd;                    /* 接收环读位置（未解析数据起点，自由增长） */
+    u32_t   rtl;                    /* 接收环写位置（自由增长） */
+    u32_t   rwp;                    /* 正在等待后续数据的不完整包的读位置 */
+    u32_t   rts;                    /* 该包开始等待的时间，同一位置等待超过一个RTO视为停滞（长度字段出错） */
+    u8_t    rwait;                  /* 接收环中有不完整的包在等待 */
+    u8_t*   txb;                    /* 发送帧缓存，mtu字节 */
+    u8_t    ftag;                   /* 包头flag的版本与保留位（TT_FTAG及可选字段TT_FCID、TT_FWND） */
+    u8_t    hsz;                    /* 包头长度（TT_SZHDR~TT_SZHDRX） */
+    u16_t   cid;                    /* 连接ID（仅版本2包头） */
+    u32_t   nrun;                   /* 从tt->ack起已连续收到的包个数 */
+    u32_t   nrcv;                   /* 接收窗口内已收到的包个数（大于nrun表示有乱序包） */
+    u16_t   ackn;                   /* 每收到多少个数据包回复一次ACK（0表示不按个数） */
+    u16_t   ackd;                   /* 延迟ACK的最长时间（毫秒，0表示不按时间） */
+    u16_t   nack;                   /* 收到后还未确认的数据包个数 */
+    u32_t   ats;                    /* 其中第一个包的到达时间 */
+    u16_t   dupk;                   /* 快速重传阈值：未确认的包之后有多少个包被确认时立即重发（0表示关闭） */
+    u8_t    early;                  /* 提前重传：已发送的包不足dupk + 1个时降低阈值（见tt_set_early） */
+
+    const tt_cc* cc;                /* 拥塞控制算法（0表示不限制，有效窗口为nwnd） */
+    u32_t   cwnd;                   /* 拥塞窗口（包个数，有效窗口为其与nwnd的较小值） */
+    u32_t   ssth;                   /* 慢启动阈值 */
+    u32_t   cacc;                   /* 拥塞避免阶段累计确认的包个数 */
+    u32_t   crec;                   /* 快速恢复结束的序号 */
+    u8_t    crcv;                   /* 是否处于快速恢复（期间的丢包不再降窗） */
+
+    u32_t   rwr;                    /* 对方接收窗口的右边沿（新包序号须小于该值，仅TT_FWND） */
+    u32_t   awr;                    /* 本端上次通告的接收窗口右边沿 */
+    u32_t   wts;                    /* 上次发送窗口探测的时间 */
+    u8_t    wnum;                   /* 窗口未打开时连续探测的次数（探测间隔按此退避） */
+
+    u8_t    fk;                     /* FEC每组数据包个数（0表示关闭） */
+    u8_t    fm;                     /* FEC每组校验包个数 */
+    u8_t    fcnt;                   /* 发送端当前组已编码的包个数（0表示下一个新包开始新的一组） */
+    u8_t    fpend;                  /* 待发送的校验包个数 */
+    u16_t   fmax;                   /* 发送端当前组最长负载 */
+    u32_t   fseq;                   /* 发送端当前组首包序号 */
+    u8_t*   fenc;                   /* 发送端编码区，fm行，每行为负载长度与负载（补0）的编码 */
+    tt_fgrp* fgrp;                  /* 接收端分组，ngrp个 */
+    u32_t*  bseq;                   /* buf各单元最近存入的包序号（交给用户后保留，用于解码） */
+    u16_t*  bpl;                    /* buf各单元最近存入的包的负载长度 */
+    u8_t*   facc;                   /* 接收端各组收到的校验行，每组fm行 */
+    u16_t   ngrp;                   /* 接收端分组个数 */
+    u32_t   nfec;                   /* 通过FEC恢复的包个数 */
+
+    u16_t*  lzh;                    /* 负载压缩的匹配哈希表，TT_LZ_HSZ个（0表示发送时不压缩） */
+    u8_t    zskip;                  /* 压缩无收益后还要跳过（不尝试压缩）的包个数 */
+    u8_t    zmiss;                  /* 连续压缩无收益的次数，跳过的包个数按此退避 */
+    u32_t   zsave;                  /* 压缩节省的字节数 */
+    u8_t    zann;                   /* 已发送的能力通告次数 */
+    u16_t   caps;                   /* 对方通告支持的功能（TT_CLZ等） */
+
+    u16_t   spl;    /* 当前发送负载长度，探测模式下动态调整 */
+    u8_t    probe;  /* 是否开启负载长度探测 */
+    u16_t   pbad;   /* 探测失败的最小负载长度（0表示未失败过） */
+    u16_t   ppl;    /* 正在探测的负载长度（0表示无） */
+    u8_t    pnum;   /* 当前长度探测连续失败次数 */
+    u32_t   pts;    /* 探测包发送时间 */
+    u16_t   ngood;  /* 上次调整后连续确认的包个数 */
+
+    u16_t   mackr;   /* 接收ACK的最大次数，超过此值后会进入重发流程（未设置时钟时使用） */
     void*   usr;
-} tt_t;
 
-/* 初始化tt_t结构体，mackr（接收ACK的最大次数）
+    tt_clk  clk;     /* 单调时钟，设置后按RTO判断是否重发 */
+    u32_t   srtt;    /* 平滑RTT（x8，毫秒） */
+    u32_t   rttvar;  /* RTT偏差（x4，毫秒） */
+    u32_t   rto;     /* 当前重传超时（毫秒） */
+    u32_t   now;     /* 当前时间（毫秒），由时钟或tt_tick更新 */
+    u8_t    tick;    /* 是否由tt_tick驱动定时 */
+};
+
+/* 初始化tt_t结构体，nwnd（窗口大小，1~TT_MAXWND，收发双方需一致），
+ * mtu（最大包长，TT_SZHDR+1~32767，收发双方需一致），mackr（接收ACK的最大次数）。
+ * 窗口、接收环（TT_SZRXB）及收发缓存通过TT_MALLOC分配，返回0成功，TT_ERRMEM表示参数错误或分配失败。
+ */
+s32_t tt_init(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr);
+
+/* 同tt_init，但窗口缓存使用调用者提供的mem（size字节，4字节对齐），不动态分配，tt_deinit时不释放。
+ * 接收环取mem能容纳的最大的2的幂（至少2*mtu，所需大小见TT_MEMSZ），返回0成功，TT_ERRMEM表示参数错误或mem过小。
+ */
+s32_t tt_init_mem(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr, void* mem, u32_t size);
+
+/* 同tt_init，但接收缓存的各单元从pool（见tt_pool.h，单元不小于mtu - TT_SZHDR）中按需借用，
+ * 收到包时借出、交给用户后归还（开启FEC时最近交付的fk个包还用于解码，晚fk个包归还），连接本身不分配接收缓存。
+ * 池已用完时收到的包按未收到处理，等待对方重发。接收环取不小于TT_SZRXP及2*mtu的2的幂（默认即2*mtu向上取2的幂）。
+ * 返回0成功，TT_ERRMEM表示参数错误或分配失败。
+ */
+s32_t tt_init_pool(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t nwnd, u16_t mtu, u16_t mackr, void* usr, tt_pool* pool);
+
+/* 释放tt_init分配的窗口缓存（使用缓存池时归还借用的单元）
+ */
+void tt_deinit(tt_t* tt);
+
+/* 使用带连接ID的版本2包头（需mtu大于TT_SZHDR2，收发双方需一致），只接受cid相同的包，
+ * 其他连接的包整包丢弃。须在收发之前调用，返回0成功，TT_ERRMEM表示mtu过小。多路复用见tt_mux.h。
+ */
+s32_t tt_set_cid(tt_t* tt, u16_t cid);
+
+/* 开启接收窗口通告（包头带wnd字段，收发双方需一致，须在收发之前调用）。开启后每个包通告本端空闲的接收缓存，
+ * 发送方不再发送超出对方窗口的新包，用户取走数据使窗口重新打开时主动回复ACK；
+ * 对方窗口已满且没有在途的包时发送窗口探测（间隔从RTO起指数退避，无回复时计入tt->nsend）。
+ * 返回0成功，TT_ERRMEM表示mtu过小。
+ */
+s32_t tt_set_rwnd(tt_t* tt, u8_t on);
+
+/* 开启前向纠错（收发双方需一致，须在收发之前调用）：新发送的包每k个（1~TT_FECK，不超过窗口）一组，
+ * 组内最后一个包发出后紧跟m个（1~TT_FECM）校验包，没有更多数据时提前为已发送的部分补发校验包；
+ * m为1时为异或校验，否则为Reed-Solomon，组内丢失不超过m个包时接收方直接恢复，无需等待重传。
+ * 校验包不占用发送窗口与拥塞窗口，不重发；k宜不超过拥塞窗口，否则组满之前的丢包仍需等待重传。
+ * 接收方只在组内有缺失时保存校验包并解码。开启后数据包负载上限减2，k或m为0时关闭。
+ * 编解码缓存通过TT_MALLOC分配，tt_deinit时释放，返回0成功，TT_ERRMEM表示参数错误或分配失败。
+ */
+s32_t tt_set_fec(tt_t* tt, u8_t k, u8_t m);
+
+/* 开启/关闭发送数据包的负载压缩（on为1/0）。每个包独立压缩（见tt_lz.h），变短时才以压缩包发送，
+ * 否则原样发送；连续无收益（不可压缩的数据）时按次数退避，跳过之后若干个包的尝试。
+ * 双方都需开启：开启后本端收到对方未压缩的数据包时回复TT_CLZ能力通告，发送方收到对方的通告后才开始压缩，
+ * 对方未开启（或为不支持压缩包的旧版本）时一直原样发送，不会因对方丢弃压缩包而卡住。
+ * 压缩后的负载写入帧缓存，不再零拷贝，批量发送时每个压缩包都会先写出已排队的包。
+ * 哈希表通过TT_MALLOC分配，tt_deinit时释放，返回0成功，TT_ERRMEM表示分配失败。
+ */
+s32_t tt_set_lz(tt_t* tt, u8_t on);
+
+/* 设置帧校验函数（收发都使用），fn须与tt_crc16结果一致（如针对特定平台的实现），传入NULL则恢复tt_crc16
+ */
+void tt_set_crc(tt_t* tt, tt_crcfn fn);
+
+/* 设置单调时钟。设置后tt_send/tt_close根据ACK往返时间估算RTO，超时即重发（超时后RTO指数退避），
+ * 不再按tt->mackr计数；传入NULL则恢复按计数重发。
+ */
+void tt_set_clock(tt_t* tt, tt_clk clk);
+
+/* 开启/关闭负载长度探测。开启后发送负载从TT_SZPL开始，连续确认TT_PRBCNT个包后发送更大的探测包，
+ * 探测成功则增大负载（最大为mtu - TT_SZHDR），失败则记录上限并在其以下二分探测；
+ * 连续两次超时重发时负载减半。关闭时发送负载固定为mtu - TT_SZHDR。
+ */
+void tt_set_probe(tt_t* tt, u8_t on);
+
+/* 设置拥塞控制算法（默认tt_cc_aimd，见tt_cc.h），传入NULL关闭，此时每轮发送整个窗口
+ */
+void tt_set_cc(tt_t* tt, const tt_cc* cc);
+
+/* 设置快速重传阈值（默认TT_DUPK）：ACK位图显示未确认的包之后已有k个包被确认时立即重发该包，
+ * 不再等待超时（或mackr次读超时）。每个包只快速重传一次，传入0关闭。
+ * 已发送的包不足k + 1个时的处理见tt_set_early；需要容忍乱序时应同时关闭提前重传。
  */
-void tt_init(tt_t* tt, tt_cb rcb, tt_cb wcb, u16_t mackr, void* usr);
+void tt_set_dupk(tt_t* tt, u16_t k);
+
+/* 开启/关闭提前重传（on为1/0，默认开启）：已发送的包不足dupk + 1个（窗口较小或数据将尽）时，
+ * 阈值降为已发送的包个数 - 1（至少1），否则这些包丢失后只能等超时。关闭后始终按dupk判定。
+ */
+void tt_set_early(tt_t* tt, u8_t on);
+
+/* 设置ACK策略。默认（n与delay都为0）每次读取（tt_input）处理完后回复一个ACK；
+ * 否则按序到达的数据包累计n个（n不为0）或最早的包等待超过delay毫秒（delay不为0，需设置时钟或tt_tick）时回复，
+ * 以先到者为准，阻塞接口读超时也会回复。乱序、重复或填补空缺的包总是立即回复。
+ */
+void tt_set_ack(tt_t* tt, u16_t n, u16_t delay);
+
+/* 设置分散写回调（可对接writev/sendmsg）。设置后数据包按包头、用户数据、CRC三段写出，
+ * tt_send不再将负载拷贝到发送缓存；其他包也通过该回调写出。传入NULL则恢复使用wcb（同时关闭批量发送）。
+ */
+void tt_set_iocb(tt_t* tt, tt_iocb iocb);
+
+/* 设置批量发送（须先设置分散写回调）。开启后tt_send每轮发送的数据包（整个窗口的新包与重发包）
+ * 排队后通过一次iocb写出，单次最多nbat个包（不超过窗口大小），传入0关闭。
+ * 排队缓存通过TT_MALLOC分配，tt_deinit时释放，返回0成功，TT_ERRMEM表示未设置分散写回调或分配失败。
+ */
+s32_t tt_set_batch(tt_t* tt, u16_t nbat);
 
 /* 重置内部状态（序列号、关闭状态等）
  */
 void tt_reset(tt_t* tt);
 
-/* 返回成功发送的字节数（可能小于len，也可能等于0，小于0表示出错）。
+/* 协议核心（不调用rcb/wcb），可在中断、事件循环或DMA完成回调中驱动协议：
+ * 收到的字节通过tt_input输入，待发送的包通过tt_poll_output取出，定时通过tt_tick推进。
+ * tt_send/tt_recv/tt_close/tt_wait是在其上封装的阻塞接口，二者不要混用于同一时刻。
+ */
+
+/* 提交待发送的数据（不拷贝，全部确认前须保持有效），返回0成功。上次提交的数据未全部确认时追加在其后
+ * （新包不跨越两次提交的数据，窗口不必等之前的数据确认完），此时tt_acked与tt->stot接着之前的数据累计；
+ * 已有TT_NSEG段未全部确认（或累计长度超出32位）时返回TT_ERRBUSY，待之前的数据确认后再提交。
+ */
+s32_t tt_submit(tt_t* tt, const u8_t* buf, u32_t len);
+
+/* 已确认的字节数（全部确认后的下一次tt_submit从0重新累计）
+ */
+#define tt_acked(ptt)        ((ptt)->una)
+
+/* 输入收到的字节（可按任意长度分段），处理其中完整的包，返回接受的字节数
+ */
+s32_t tt_input(tt_t* tt, const u8_t* data, u32_t len);
+
+/* 取出下一个待发送的包写入buf（len不小于mtu），返回包长，0表示当前没有待发送的包
+ */
+s32_t tt_poll_output(tt_t* tt, u8_t* buf, u32_t len);
+
+/* 以当前时间now（毫秒，允许回绕）推进定时器，超时的包登记为待重发（由tt_poll_output取出）。
+ * 连续超时次数为tt->nsend，由调用者决定何时放弃。
+ */
+void tt_tick(tt_t* tt, u32_t now);
+
+/* 距下一个定时器到期的毫秒数（0表示已到期），没有需要定时的事件时返回-1
+ */
+s32_t tt_timeout(tt_t* tt);
+
+/* 取走按序到达的数据，返回字节数（0表示没有数据）。同一连接可以同时用tt_submit发送、用tt_read接收。
+ */
+s32_t tt_read(tt_t* tt, u8_t* buf, s32_t len);
+
+/* 主动关闭：登记FIN（未确认的数据不再重发），对方回复后tt_is_closed()为1，超时由tt_tick重发
+ */
+void tt_shutdown(tt_t* tt);
+
+/* 返回成功发送的字节数（可能小于len，也可能等于0，小于0表示出错，写出失败时为TT_ERRSEND）。
  * 连续发送数据包次数达到msend且无有效ACK时该函数会返回（返回当前已成功发送的字节数）。
- * 发送数据包后，连续接收ACK次数达到tt->mackr且无有效ACK时会重发。
+ * 发送数据包后，连续接收ACK次数达到tt->mackr（设置了时钟时为等待超过tt->rto）且无有效ACK时会重发。
+ * 返回值r小于len时，剩余数据须以tt_send(tt, buf + r, len - r, ...)重新传入（已发出未确认的包按原来的划分继续重发），
+ * 发送其他数据前上次的数据应已全部确认。
  */
 s32_t tt_send(tt_t* tt, const u8_t* buf, s32_t len, s32_t msend);
 
-/* 返回成功接收的字节数（可能小于len，也可能等于0，小于0表示出错）
+/* 返回成功接收的字节数（可能小于len，也可能等于0，小于0表示出错：TT_ERRRECV为读出错，TT_ERRSEND为回复ACK写出失败）
  * 连续接收数据包mrecv次无有效数据包时该函数会返回（返回当前已成功收到的字节数）。
  */
 s32_t tt_recv(tt_t* tt, u8_t* buf, s32_t len, s32_t mrecv);
 
+/* 零拷贝接收：接收直到有按序到达的数据（超时规则同tt_recv），将接收缓存中按序数据块的位置依次填入iov（最多niov个），
+ * 返回填入的个数（等于0表示超时无数据，小于0表示出错）。
+ * iov指向tt内部的接收缓存，在调用tt_release释放之前一直有效；释放前再次调用会从同一位置重新填入。
+ */
+s32_t tt_recv_zc(tt_t* tt, tt_iov* iov, s32_t niov, s32_t mrecv);
+
+/* 释放tt_recv_zc借出的len字节（从最早的数据开始，可以只释放一部分），完整释放的包移出接收窗口
+ */
+void tt_release(tt_t* tt, s32_t len);
+
 /* 发送FIN包。发送方（tt_send）可调用该接口，以告知对方已无后续数据。
  * 接收方（tt_recv）也可调用该接口，以告知对方不会再接收发过来的数据。
  * 当发送FIN包次数达到msend且未收到回复时该函数返回0，有收到回复也会返回0但tt_is_closed()会返回1.
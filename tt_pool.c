@@ -0,0 +1,125 @@
+#include "tt_pool.h"
+
+#if TT_USE_STD_FUNC
+#include <stdlib.h>
+
+#define tt_malloc   malloc
+#define tt_free     free
+#else
+#define tt_malloc   TT_MALLOC
+#define tt_free     TT_FREE
+#endif
+
+/* 块开头存放下一个块的指针，之后是n个单元 */
+#define TT_POOL_HDR     sizeof(void*)
+
+/* 上限的1/8保留给按序到达的包 */
+static u32_t pool_resv(u32_t nmax)
+{
+    return nmax ? (nmax >> 3 ? nmax >> 3 : 1) : 0;
+}
+
+/* 申请一个块（n个单元）并把单元挂到空闲链表 */
+static s32_t pool_grow(tt_pool* pool, u32_t n)
+{
+    u8_t* c;
+    u8_t* p;
+    u32_t i;
+
+    /* 块大小按u32_t计算，不能溢出 */
+    if (n > (0xffffffffu - TT_POOL_HDR) / pool->stride) return TT_ERRMEM;
+
+    c = tt_malloc(TT_POOL_HDR + n * pool->stride);
+    if (!c) return TT_ERRMEM;
+
+    *(void**) c = pool->chk;
+    pool->chk = c;
+
+    for (i = n, p = c + TT_POOL_HDR; i > 0; --i, p += pool->stride) {
+        *(void**) p = pool->free;
+        pool->free = p;
+    }
+
+    pool->nall += n;
+
+    return 0;
+}
+
+s32_t tt_pool_init(tt_pool* pool, u32_t bsz, u32_t nmax, u32_t nchk)
+{
+    if (!bsz) return TT_ERRMEM;
+
+    if (!nchk) nchk = TT_POOL_CHK;
+    if (nmax && nchk > nmax) nchk = nmax;
+
+    pool->bsz = bsz;
+    pool->nmax = nmax;
+    pool->nresv = pool_resv(nmax);
+    pool->nchk = nchk;
+    pool->stride = (bsz + sizeof(void*) - 1) & ~(u32_t) (sizeof(void*) - 1);
+    pool->free = 0;
+    pool->chk = 0;
+    pool->nall = 0;
+    pool->nused = 0;
+    pool->npeak = 0;
+    pool->nget = 0;
+    pool->nfail = 0;
+
+    return 0;
+}
+
+void tt_pool_deinit(tt_pool* pool)
+{
+    void* c;
+
+    while ((c = pool->chk)) {
+        pool->chk = *(void**) c;
+        tt_free(c);
+    }
+
+    pool->free = 0;
+    pool->nall = 0;
+    pool->nused = 0;
+}
+
+u8_t* tt_pool_get(tt_pool* pool, u8_t ord)
+{
+    u32_t n = pool->nchk;
+    u8_t* p;
+
+    if (pool->nmax && pool->nused + (ord ? 0 : pool->nresv) >= pool->nmax) {
+        ++pool->nfail;
+        return 0;
+    }
+
+    if (!pool->free) {
+        if (pool->nmax && n > pool->nmax - pool->nall) n = pool->nmax - pool->nall;
+
+        if (pool_grow(pool, n) < 0) {
+            ++pool->nfail;
+            return 0;
+        }
+    }
+
+    p = pool->free;
+    pool->free = *(void**) p;
+
+    ++pool->nget;
+    if (++pool->nused > pool->npeak) pool->npeak = pool->nused;
+
+    return p;
+}
+
+void tt_pool_put(tt_pool* pool, u8_t* p)
+{
+    *(void**) p = pool->free;
+    pool->free = p;
+    --pool->nused;
+}
+
+void tt_pool_limit(tt_pool* pool, u32_t nmax)
+{
+    pool->nmax = nmax;
+    pool->nresv = pool_resv(nmax);
+    if (nmax && pool->nchk > nmax) pool->nchk = nmax;
+}
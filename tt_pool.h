@@ -0,0 +1,52 @@
+#ifndef _TT_POOL_H_
+#define _TT_POOL_H_
+
+#include "tt.h"
+
+/* 接收缓存池（tt_init_pool）：多个连接共享的定长单元池，连接收到包（乱序或未交给用户）时借出一个单元存放负载，
+ * 交给用户后归还，空闲的连接不占用接收缓存。单元按块（nchk个）向系统申请，直到tt_pool_deinit才释放，
+ * 借出的单元数达到上限时借用失败，该包按未收到处理（不确认，等待对方重发）。上限中保留一部分单元只借给按序到达的包，
+ * 避免各连接的乱序包占满池后，填补空缺的包借不到单元而无法交付（死锁）。
+ * 池不加锁，共享同一个池的连接须在同一线程中使用（如同一个reactor/mux）。
+ */
+
+#define TT_POOL_CHK     64      /* 默认每次申请的单元个数 */
+
+struct tt_pool_s {
+    u32_t   bsz;        /* 单元大小（字节），不小于使用该池的连接的mtu - TT_SZHDR */
+    u32_t   nmax;       /* 单元个数上限（0表示不限制） */
+    u32_t   nresv;      /* 有上限时只借给按序到达的包的单元个数（默认为上限的1/8，至少1个，可修改） */
+    u32_t   nchk;       /* 每次申请的单元个数 */
+    u32_t   stride;     /* 单元间隔（bsz按指针大小对齐） */
+    void*   free;       /* 空闲单元链表（单元开头存放下一个空闲单元） */
+    void*   chk;        /* 已申请的块链表（块开头存放下一个块） */
+
+    u32_t   nall;       /* 已申请的单元个数 */
+    u32_t   nused;      /* 借出的单元个数 */
+    u32_t   npeak;      /* 借出个数的峰值 */
+    u32_t   nget;       /* 借用成功的次数 */
+    u32_t   nfail;      /* 因达到上限或申请失败而借用失败的次数 */
+};
+
+/* 初始化缓存池，bsz为单元大小，nmax为单元个数上限（0不限制），nchk为每次申请的单元个数（0为TT_POOL_CHK，
+ * 有上限时不超过上限）。不预先申请，返回0成功，TT_ERRMEM表示参数错误。
+ */
+s32_t tt_pool_init(tt_pool* pool, u32_t bsz, u32_t nmax, u32_t nchk);
+
+/* 释放缓存池申请的全部内存，须在使用该池的连接都tt_deinit之后调用
+ */
+void tt_pool_deinit(tt_pool* pool);
+
+/* 借出一个单元，ord为0（乱序的包）时不使用保留的单元，失败时返回0
+ */
+u8_t* tt_pool_get(tt_pool* pool, u8_t ord);
+
+/* 归还tt_pool_get借出的单元
+ */
+void tt_pool_put(tt_pool* pool, u8_t* p);
+
+/* 修改单元个数上限（已借出的单元不受影响，超出部分归还后不再借出），nresv按新的上限重新计算
+ */
+void tt_pool_limit(tt_pool* pool, u32_t nmax);
+
+#endif // _TT_POOL_H_
@@ -0,0 +1,468 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "tt_reactor.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define TT_NEVENT       256     /* 单次epoll_wait最多取出的事件数 */
+
+/* 定时比较（允许回绕） */
+#define TT_BEFORE(a, b) ((s32_t) ((u32_t) (a) - (u32_t) (b)) < 0)
+
+static u32_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u32_t) ts.tv_sec * 1000 + (u32_t) (ts.tv_nsec / 1000000);
+}
+
+static void heap_set(tt_reactor* r, u32_t i, tt_link* lk)
+{
+    r->heap[i] = lk;
+    lk->hidx = i;
+}
+
+static void heap_up(tt_reactor* r, u32_t i)
+{
+    tt_link* lk = r->heap[i];
+    u32_t p;
+
+    while (i > 0) {
+        p = (i - 1) / 2;
+        if (!TT_BEFORE(lk->due, r->heap[p]->due)) break;
+
+        heap_set(r, i, r->heap[p]);
+        i = p;
+    }
+
+    heap_set(r, i, lk);
+}
+
+static void heap_down(tt_reactor* r, u32_t i)
+{
+    tt_link* lk = r->heap[i];
+    u32_t c;
+
+    while ((c = 2 * i + 1) < r->nheap) {
+        if (c + 1 < r->nheap && TT_BEFORE(r->heap[c + 1]->due, r->heap[c]->due)) ++c;
+        if (!TT_BEFORE(r->heap[c]->due, lk->due)) break;
+
+        heap_set(r, i, r->heap[c]);
+        i = c;
+    }
+
+    heap_set(r, i, lk);
+}
+
+static void heap_del(tt_reactor* r, tt_link* lk)
+{
+    tt_link* t;
+    u32_t i;
+
+    if (lk->hidx < 0) return;
+
+    i = lk->hidx;
+    lk->hidx = -1;
+    if (i == --r->nheap) return;
+
+    /* 用最后一个元素填补空位后调整 */
+    t = r->heap[r->nheap];
+    heap_set(r, i, t);
+    heap_up(r, i);
+    heap_down(r, t->hidx);
+}
+
+static s32_t heap_add(tt_reactor* r, tt_link* lk)
+{
+    tt_link** h;
+    u32_t n;
+
+    if (r->nheap == r->cheap) {
+        n = r->cheap ? r->cheap * 2 : 64;
+        h = realloc(r->heap, n * sizeof(tt_link*));
+        if (!h) return TT_ERRMEM;
+
+        r->heap = h;
+        r->cheap = n;
+    }
+
+    heap_set(r, r->nheap++, lk);
+    heap_up(r, lk->hidx);
+
+    return 0;
+}
+
+/* 按堆顶的到期时间设置timerfd */
+static void timer_arm(tt_reactor* r, u32_t now)
+{
+    struct itimerspec its;
+    s32_t d;
+
+    if (!r->nheap) {
+        if (r->armed) {
+            memset(&its, 0, sizeof(its));
+            timerfd_settime(r->tfd, 0, &its, 0);
+            r->armed = 0;
+        }
+        return;
+    }
+
+    if (r->armed && r->tarm == r->heap[0]->due) return;
+
+    d = (s32_t) (r->heap[0]->due - now);
+    if (d < 1) d = 1;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = d / 1000;
+    its.it_value.tv_nsec = (d % 1000) * 1000000L;
+    timerfd_settime(r->tfd, 0, &its, 0);
+
+    r->tarm = r->heap[0]->due;
+    r->armed = 1;
+}
+
+/* 根据连接的下一个定时事件更新定时堆 */
+static void link_sched(tt_link* lk, u32_t now)
+{
+    tt_reactor* r = lk->r;
+    s32_t t = lk->dead ? -1 : tt_timeout(&lk->tt);
+
+    if (t < 0) {
+        heap_del(r, lk);
+        return;
+    }
+
+    /* 已到期但包还未写出（等待EPOLLOUT）时至少推迟1毫秒，避免空转 */
+    lk->due = now + (t > 0 ? t : 1);
+
+    if (lk->hidx < 0) {
+        heap_add(r, lk);
+    } else {
+        heap_up(r, lk->hidx);
+        heap_down(r, lk->hidx);
+    }
+}
+
+/* 出错的连接（读到EOF、读写出错）不再关注fd，避免水平触发的epoll反复报告同一事件而空转 */
+static void link_detach(tt_link* lk)
+{
+    heap_del(lk->r, lk);
+    epoll_ctl(lk->r->ep, EPOLL_CTL_DEL, lk->fd, 0);
+}
+
+static void link_event(tt_link* lk, s32_t ev)
+{
+    if (ev != TT_EV_SENT) lk->dead = 1;
+    lk->cb(lk, ev, 0, 0);
+}
+
+static void link_wout(tt_link* lk, u8_t on)
+{
+    struct epoll_event ev;
+
+    if (lk->wout == on) return;
+
+    ev.events = EPOLLIN | (on ? EPOLLOUT : 0);
+    ev.data.ptr = lk;
+    epoll_ctl(lk->r->ep, EPOLL_CTL_MOD, lk->fd, &ev);
+
+    lk->wout = on;
+}
+
+/* 写出待发送的包：先写完上次未写完的包，写不完（部分写/EAGAIN）时暂存并关注EPOLLOUT */
+static s32_t link_flush(tt_link* lk)
+{
+    ssize_t w;
+    s32_t n;
+
+    while (1) {
+        if (!lk->olen) {
+            n = tt_poll_output(&lk->tt, lk->tt.txb, lk->tt.mtu);
+            if (n <= 0) break;
+
+            lk->olen = n;
+            lk->ooff = 0;
+        }
+
+        w = write(lk->fd, lk->tt.txb + lk->ooff, lk->olen - lk->ooff);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                link_wout(lk, 1);
+                return 0;
+            }
+            return -1;
+        }
+
+        lk->ooff += w;
+        if (lk->ooff < lk->olen) {
+            link_wout(lk, 1);
+            return 0;
+        }
+
+        lk->olen = 0;
+    }
+
+    link_wout(lk, 0);
+    return 0;
+}
+
+/* 推进定时、写出、报告状态变化并重新安排定时 */
+static void link_service(tt_link* lk, u32_t now)
+{
+    tt_tick(&lk->tt, now);
+
+    if (link_flush(lk) < 0) {
+        if (!lk->dead) link_event(lk, TT_EV_ERROR);
+        link_detach(lk);
+        return;
+    }
+
+    if (!lk->sent && tt_acked(&lk->tt) == lk->tt.stot) {
+        lk->sent = 1;
+        link_event(lk, TT_EV_SENT);
+    }
+
+    if (!lk->dead && tt_is_closed(&lk->tt)) {
+        link_event(lk, TT_EV_CLOSED);
+    }
+
+    if (!lk->dead && lk->tt.nsend >= lk->r->maxrtx) {
+        link_event(lk, TT_EV_TIMEOUT);
+    }
+
+    link_sched(lk, now);
+}
+
+/* fd可读：读到EAGAIN为止，输入协议核心并交付数据 */
+static void link_input(tt_link* lk, u32_t now)
+{
+    u8_t* buf = lk->r->rbuf;
+    ssize_t n;
+    s32_t m;
+
+    tt_tick(&lk->tt, now);
+
+    while (1) {
+        n = read(lk->fd, buf, TT_RSZBUF);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        }
+
+        if (n <= 0) {
+            if (!lk->dead) link_event(lk, TT_EV_ERROR);
+            link_detach(lk);
+            return;
+        }
+
+        tt_input(&lk->tt, buf, n);
+
+        /* 读缓存中的数据已输入，可复用来交付数据 */
+        while ((m = tt_read(&lk->tt, buf, TT_RSZBUF)) > 0) {
+            lk->cb(lk, TT_EV_DATA, buf, m);
+        }
+    }
+
+    link_service(lk, now);
+}
+
+s32_t tt_reactor_init(tt_reactor* r)
+{
+    struct epoll_event ev;
+
+    memset(r, 0, sizeof(tt_reactor));
+    r->maxrtx = TT_RMAXRTX;
+
+    r->ep = epoll_create1(EPOLL_CLOEXEC);
+    r->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    r->rbuf = malloc(TT_RSZBUF);
+
+    if (r->ep < 0 || r->tfd < 0 || !r->rbuf) {
+        tt_reactor_deinit(r);
+        return TT_ERRMEM;
+    }
+
+    /* timerfd的data.ptr为0，与连接区分 */
+    ev.events = EPOLLIN;
+    ev.data.ptr = 0;
+    if (epoll_ctl(r->ep, EPOLL_CTL_ADD, r->tfd, &ev) < 0) {
+        tt_reactor_deinit(r);
+        return TT_ERRMEM;
+    }
+
+    return 0;
+}
+
+void tt_reactor_deinit(tt_reactor* r)
+{
+    if (r->ep >= 0) close(r->ep);
+    if (r->tfd >= 0) close(r->tfd);
+
+    free(r->heap);
+    free(r->rbuf);
+
+    r->ep = -1;
+    r->tfd = -1;
+    r->heap = 0;
+    r->rbuf = 0;
+    r->nheap = 0;
+    r->cheap = 0;
+}
+
+s32_t tt_reactor_run(tt_reactor* r, s32_t timeout)
+{
+    struct epoll_event evs[TT_NEVENT];
+    tt_link* lk;
+    uint64_t exp;
+    u32_t now;
+    s32_t n;
+    s32_t i;
+
+    n = epoll_wait(r->ep, evs, TT_NEVENT, timeout);
+    if (n < 0) {
+        return errno == EINTR ? 0 : TT_ERRRECV;
+    }
+
+    now = now_ms();
+
+    for (i = 0; i < n; ++i) {
+        lk = evs[i].data.ptr;
+
+        if (!lk) {
+            /* 定时到期：处理所有已到期的连接 */
+            /* 清除timerfd的可读状态（非阻塞，已被清除时返回EAGAIN） */
+            if (read(r->tfd, &exp, sizeof(exp)) < 0) exp = 0;
+            r->armed = 0;
+
+            while (r->nheap && !TT_BEFORE(now, r->heap[0]->due)) {
+                lk = r->heap[0];
+                heap_del(r, lk);
+                link_service(lk, now);
+            }
+            continue;
+        }
+
+        if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            link_input(lk, now);
+        } else if (evs[i].events & EPOLLOUT) {
+            link_service(lk, now);
+        }
+    }
+
+    timer_arm(r, now);
+
+    return n;
+}
+
+/* 不使用缓存池时由反应器分配窗口缓存：tt_input每次只需暂存一个不完整的帧，接收环取2*mtu（向上取2的幂）即可，
+ * 不按TT_SZRXB为每个连接分配大的接收环
+ */
+static s32_t link_init(tt_link* lk, u16_t nwnd, u16_t mtu)
+{
+    u32_t rsz = 1;
+    u32_t size;
+    s32_t rt;
+
+    /* 其余参数由tt_init_mem检查 */
+    if (mtu <= TT_SZHDR) return TT_ERRMEM;
+    while (rsz < 2u * mtu) rsz <<= 1;
+
+    size = TT_MEMSZ(nwnd, mtu, rsz);
+    lk->mem = malloc(size);
+    if (!lk->mem) return TT_ERRMEM;
+
+    rt = tt_init_mem(&lk->tt, 0, 0, nwnd, mtu, 0, lk, lk->mem, size);
+    if (rt < 0) {
+        free(lk->mem);
+        lk->mem = 0;
+    }
+
+    return rt;
+}
+
+s32_t tt_link_open(tt_reactor* r, tt_link* lk, int fd, u16_t nwnd, u16_t mtu, tt_lkcb cb, void* usr)
+{
+    struct epoll_event ev;
+    s32_t rt;
+
+    memset(lk, 0, sizeof(tt_link));
+
+    /* 反应器通过协议核心收发，不使用rcb/wcb；未写完的包暂存在连接的发送帧缓存（txb）中 */
+    rt = r->pool ? tt_init_pool(&lk->tt, 0, 0, nwnd, mtu, 0, lk, r->pool)
+                 : link_init(lk, nwnd, mtu);
+    if (rt < 0) return rt;
+
+    lk->fd = fd;
+    lk->r = r;
+    lk->cb = cb;
+    lk->usr = usr;
+    lk->sent = 1;
+    lk->hidx = -1;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = lk;
+    if (epoll_ctl(r->ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        tt_deinit(&lk->tt);
+        free(lk->mem);
+        lk->mem = 0;
+        return TT_ERRMEM;
+    }
+
+    lk->tt.now = now_ms();
+
+    return 0;
+}
+
+void tt_link_remove(tt_link* lk)
+{
+    tt_reactor* r = lk->r;
+
+    heap_del(r, lk);
+    epoll_ctl(r->ep, EPOLL_CTL_DEL, lk->fd, 0);
+    timer_arm(r, now_ms());
+
+    tt_deinit(&lk->tt);
+    free(lk->mem);
+    lk->mem = 0;
+}
+
+s32_t tt_link_send(tt_link* lk, const u8_t* buf, u32_t len)
+{
+    u32_t now = now_ms();
+    s32_t rt;
+
+    tt_tick(&lk->tt, now);
+
+    rt = tt_submit(&lk->tt, buf, len);
+    if (rt < 0) return rt;
+
+    lk->sent = 0;
+
+    link_service(lk, now);
+    timer_arm(lk->r, now);
+
+    return 0;
+}
+
+void tt_link_close(tt_link* lk)
+{
+    u32_t now = now_ms();
+
+    tt_tick(&lk->tt, now);
+    tt_shutdown(&lk->tt);
+
+    link_service(lk, now);
+    timer_arm(lk->r, now);
+}
@@ -0,0 +1,89 @@
+#ifndef _TT_REACTOR_H_
+#define _TT_REACTOR_H_
+
+#include "tt.h"
+
+/* 基于epoll的反应器（仅Linux）：单线程管理大量非阻塞fd上的tt连接。
+ * fd读就绪时读到EAGAIN为止并通过tt_input输入协议核心，待发送的包通过tt_poll_output取出写出，
+ * 写不完的部分（部分写/EAGAIN）暂存并等待EPOLLOUT；所有连接的重传定时共用一个timerfd，
+ * 按到期时间组织为最小堆。
+ */
+
+#define TT_EV_DATA      0   /* 收到数据（buf/len有效） */
+#define TT_EV_SENT      1   /* tt_link_send提交的数据已全部确认 */
+#define TT_EV_CLOSED    2   /* 连接已关闭（对方FIN或本端关闭完成） */
+#define TT_EV_TIMEOUT   3   /* 连续超时重发次数达到tt_reactor.maxrtx */
+#define TT_EV_ERROR     4   /* fd读写出错或对端关闭fd，报告后该fd不再加入epoll */
+
+#define TT_RMAXRTX      8       /* 默认连续超时重发多少次后报告TT_EV_TIMEOUT */
+#define TT_RSZBUF       65536   /* 反应器共用的读缓存大小 */
+
+typedef struct tt_link tt_link;
+
+/* 连接事件回调，ev为TT_EV_*，仅TT_EV_DATA时buf/len有效（回调返回后失效）。
+ * 回调中可以调用tt_link_send/tt_link_close，但不要调用tt_link_remove。
+ */
+typedef void (*tt_lkcb)(tt_link* lk, s32_t ev, const u8_t* buf, u32_t len);
+
+typedef struct {
+    int         ep;     /* epoll fd */
+    int         tfd;    /* timerfd */
+    tt_link**   heap;   /* 定时最小堆（按到期时间） */
+    u32_t       nheap;
+    u32_t       cheap;
+    u32_t       tarm;   /* timerfd当前设置的到期时间（heap为空时无效） */
+    u8_t        armed;
+    u8_t*       rbuf;   /* 共用的读缓存 */
+    u16_t       maxrtx; /* 连续超时重发多少次后报告TT_EV_TIMEOUT（默认TT_RMAXRTX，可在tt_reactor_init后修改） */
+    tt_pool*    pool;   /* 接收缓存池（可在tt_reactor_init后设置），之后打开的连接从中借用接收缓存（见tt_init_pool） */
+} tt_reactor;
+
+struct tt_link {
+    tt_t        tt;
+    int         fd;
+    tt_reactor* r;
+    tt_lkcb     cb;
+    void*       usr;
+
+    void*       mem;    /* 不使用缓存池时反应器分配的窗口缓存（见tt_init_mem） */
+    u32_t       ooff;   /* 未写完的包（在tt.txb中）已写出的字节数 */
+    u32_t       olen;   /* 未写完的包的长度，0表示没有 */
+    u8_t        wout;   /* 是否已关注EPOLLOUT */
+    u8_t        sent;   /* 已提交的数据是否已报告TT_EV_SENT */
+    u8_t        dead;   /* 已报告TT_EV_CLOSED/TT_EV_TIMEOUT/TT_EV_ERROR */
+
+    u32_t       due;    /* 定时到期时间 */
+    s32_t       hidx;   /* 在定时堆中的下标，-1表示不在堆中 */
+};
+
+/* 初始化反应器，返回0成功，小于0失败
+ */
+s32_t tt_reactor_init(tt_reactor* r);
+
+/* 释放反应器（不关闭各连接的fd）
+ */
+void tt_reactor_deinit(tt_reactor* r);
+
+/* 等待并处理一轮事件，timeout为最长等待毫秒数（-1为一直等待），返回处理的事件数，小于0表示出错
+ */
+s32_t tt_reactor_run(tt_reactor* r, s32_t timeout);
+
+/* 将fd加入反应器（fd会被设置为非阻塞），nwnd/mtu同tt_init，返回0成功，小于0失败。
+ * 连接的接收环只取2*mtu（向上取2的幂），不按TT_SZRXB分配；设置了缓存池时接收缓存也从池中借用。
+ */
+s32_t tt_link_open(tt_reactor* r, tt_link* lk, int fd, u16_t nwnd, u16_t mtu, tt_lkcb cb, void* usr);
+
+/* 从反应器移除连接并释放其缓存（不关闭fd）
+ */
+void tt_link_remove(tt_link* lk);
+
+/* 提交待发送的数据（不拷贝，收到TT_EV_SENT前须保持有效），返回0成功。之前提交的数据未确认时追加在其后
+ * （见tt_submit，段数用完时返回TT_ERRBUSY），TT_EV_SENT在已提交的数据全部确认后报告
+ */
+s32_t tt_link_send(tt_link* lk, const u8_t* buf, u32_t len);
+
+/* 主动关闭连接，完成后报告TT_EV_CLOSED
+ */
+void tt_link_close(tt_link* lk);
+
+#endif // _TT_REACTOR_H_
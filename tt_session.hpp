@@ -0,0 +1,165 @@
+#ifndef _TT_SESSION_HPP_
+#define _TT_SESSION_HPP_
+
+/* C++封装（C++20，仅头文件）：tt::session<Window, Mtu, Checksum>把窗口大小、mtu与帧校验实现作为模板参数，
+ * 同一程序中可以同时使用不同配置的连接（如185字节的串口与1400字节的UDP）。
+ * 窗口缓存按模板参数计算大小（tt_init_mem，接收环只取2*Mtu向上取2的幂）嵌在对象中，不动态分配；对象析构时tt_deinit。
+ * 编译期确定的只有内存布局。收发路径在C实现中，不按模板参数特化：校验策略只是构造时传给tt_set_crc的函数指针，
+ * 每帧经该指针调用一次，开销在于其实现本身（默认的crc_auto即tt_crc16，按CPU选用CLMUL或slice-by-8）。
+ * 底层仍为tt_new.c的同一份实现，协议行为与直接使用tt_*函数完全一致，get()返回tt_t*可调用其他tt_*接口。
+ */
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+extern "C" {
+#include "tt.h"
+#include "tt_crc.h"
+}
+
+namespace tt {
+
+/* 校验策略：fn为tt_set_crc设置的校验函数（须与tt_crc16结果一致，nullptr表示tt_crc16，实现由tt_crc_select决定）。
+ * 其他策略同样提供static constexpr tt_crcfn fn，如针对特定平台（硬件CRC外设）的实现。
+ */
+struct crc_auto {
+    static constexpr tt_crcfn fn = nullptr;
+};
+
+/* tt_recv_zc借出的数据块（最多N个），只能移动；析构或release()时归还（tt_release）全部字节 */
+template <std::size_t N = 8>
+class lease {
+public:
+    lease() = default;
+    lease(const lease&) = delete;
+    lease& operator=(const lease&) = delete;
+
+    lease(lease&& o) noexcept : tt_(std::exchange(o.tt_, nullptr)), n_(std::exchange(o.n_, 0))
+    {
+        for (s32_t i = 0; i < n_; ++i) iov_[i] = o.iov_[i];
+    }
+
+    lease& operator=(lease&& o) noexcept
+    {
+        if (this != &o) {
+            release();
+            tt_ = std::exchange(o.tt_, nullptr);
+            n_ = std::exchange(o.n_, 0);
+            for (s32_t i = 0; i < n_; ++i) iov_[i] = o.iov_[i];
+        }
+        return *this;
+    }
+
+    ~lease() { release(); }
+
+    /* 数据块个数（0表示超时无数据或出错） */
+    std::size_t size() const { return (std::size_t) n_; }
+    bool empty() const { return n_ <= 0; }
+
+    std::span<const u8_t> operator[](std::size_t i) const { return {iov_[i].buf, iov_[i].len}; }
+
+    /* 借出的总字节数 */
+    std::size_t bytes() const
+    {
+        std::size_t n = 0;
+        for (s32_t i = 0; i < n_; ++i) n += iov_[i].len;
+        return n;
+    }
+
+    void release()
+    {
+        if (tt_ && n_ > 0) tt_release(tt_, (s32_t) bytes());
+        tt_ = nullptr;
+        n_ = 0;
+    }
+
+private:
+    template <u16_t, u16_t, class> friend class session;
+
+    tt_t*   tt_ = nullptr;
+    s32_t   n_ = 0;
+    tt_iov  iov_[N];
+};
+
+template <u16_t Window = TT_SZWND, u16_t Mtu = TT_SZPKT, class Checksum = crc_auto>
+class session {
+    static_assert(Window >= 1 && Window <= TT_MAXWND, "Window must be 1..TT_MAXWND");
+    static_assert(Mtu > TT_SZHDR && Mtu <= 0x7fff, "Mtu must be TT_SZHDR+1..32767");
+
+    static constexpr u32_t pow2(u32_t n)
+    {
+        u32_t r = 1;
+        while (r < n) r <<= 1;
+        return r;
+    }
+
+public:
+    static constexpr u16_t window = Window;
+    static constexpr u16_t mtu = Mtu;
+    static constexpr u16_t header = TT_SZHDR;
+    static constexpr u16_t max_payload = Mtu - TT_SZHDR;
+    /* 接收环大小：不小于2*mtu的2的幂（与tt_init_pool相同，不按TT_SZRXB），对象可以放在栈上 */
+    static constexpr u32_t ring = pow2(2u * Mtu);
+    static constexpr u32_t mem_size = TT_MEMSZ(Window, Mtu, ring);
+
+    using checksum = Checksum;
+
+    session(tt_cb rcb, tt_cb wcb, u16_t mackr, void* usr)
+    {
+        /* 参数与内存大小已在编译期检查，不会失败 */
+        tt_init_mem(&tt_, rcb, wcb, Window, Mtu, mackr, usr, mem_, sizeof(mem_));
+        tt_set_crc(&tt_, Checksum::fn);
+    }
+
+    /* tt_t内部指针指向mem_，对象不能拷贝或移动 */
+    session(const session&) = delete;
+    session& operator=(const session&) = delete;
+
+    ~session() { tt_deinit(&tt_); }
+
+    tt_t* get() { return &tt_; }
+    const tt_t* get() const { return &tt_; }
+
+    s32_t send(std::span<const u8_t> data, s32_t msend)
+    {
+        return tt_send(&tt_, data.data(), (s32_t) data.size(), msend);
+    }
+
+    s32_t recv(std::span<u8_t> buf, s32_t mrecv)
+    {
+        return tt_recv(&tt_, buf.data(), (s32_t) buf.size(), mrecv);
+    }
+
+    /* 零拷贝接收，出错时返回空的lease */
+    template <std::size_t N = 8>
+    lease<N> recv_zc(s32_t mrecv)
+    {
+        lease<N> l;
+        s32_t n = tt_recv_zc(&tt_, l.iov_, (s32_t) N, mrecv);
+
+        if (n > 0) {
+            l.tt_ = &tt_;
+            l.n_ = n;
+        }
+        return l;
+    }
+
+    s32_t submit(std::span<const u8_t> data) { return tt_submit(&tt_, data.data(), (u32_t) data.size()); }
+    s32_t input(std::span<const u8_t> data) { return tt_input(&tt_, data.data(), (u32_t) data.size()); }
+    s32_t poll_output(std::span<u8_t> buf) { return tt_poll_output(&tt_, buf.data(), (u32_t) buf.size()); }
+    s32_t read(std::span<u8_t> buf) { return tt_read(&tt_, buf.data(), (s32_t) buf.size()); }
+    void tick(u32_t now) { tt_tick(&tt_, now); }
+
+    s32_t close(s32_t msend) { return tt_close(&tt_, msend); }
+    s32_t wait(s32_t mrecv) { return tt_wait(&tt_, mrecv); }
+    bool closed() const { return tt_is_closed(&tt_); }
+
+private:
+    tt_t    tt_;
+    alignas(8) u8_t mem_[mem_size];
+};
+
+} // namespace tt
+
+#endif // _TT_SESSION_HPP_